@@ -1177,7 +1177,9 @@ void generate_service_implementation(const std::string &outputdirectory, ClassDe
 			}
 			out << ") {" << std::endl;
 			// out << "\t\t" << "std::cerr << \"service dispatch function called!!!!!!!!!!!!\" << std::endl;" << std::endl;
-			out << "\t\t" << "saftbus::Serializer serialized_signal;" << std::endl;
+			// the same Serializer is reused for all signals, it keeps its capacity between emissions
+			out << "\t\t" << "saftbus::Serializer &serialized_signal = get_signal_serializer();" << std::endl;
+			out << "\t\t" << "serialized_signal.put_init();" << std::endl;
 			out << "\t\t" << "serialized_signal.put(get_object_id());" << std::endl;
 			out << "\t\t" << "serialized_signal.put(" << interface_no    << ");" << std::endl;
 			out << "\t\t" << "serialized_signal.put(" << signal_no       << ");" << std::endl;
@@ -1199,6 +1201,38 @@ void generate_service_implementation(const std::string &outputdirectory, ClassDe
 }
 
 
+// functions with output arguments (non-const references) get no asynchronous variant
+bool has_output_arguments(FunctionSignature &function) {
+	for (auto &argument: function.argument_list) {
+		if (argument.is_output) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// a lambda "on_reply_" that unpacks the reply of a function call into "promise_"
+void generate_reply_handler(std::ostream &cpp_out, FunctionSignature &function) {
+		cpp_out << "\t\t" << "int saftbus_object_id_ = get_saftbus_object_id();" << std::endl;
+		cpp_out << "\t\t" << "auto on_reply_ = [promise_, saftbus_object_id_](saftbus::Deserializer &received_) {" << std::endl;
+		cpp_out << "\t\t\t" << "saftbus::FunctionResult function_result_;" << std::endl;
+		cpp_out << "\t\t\t" << "received_.get(function_result_);" << std::endl;
+		cpp_out << "\t\t\t" << "if (function_result_ == saftbus::FunctionResult::EXCEPTION) {" << std::endl;
+		cpp_out << "\t\t\t\t" << "std::string what;" << std::endl;
+		cpp_out << "\t\t\t\t" << "received_.get(what);" << std::endl;
+		cpp_out << "\t\t\t\t" << "promise_->set_exception(remote_exception(saftbus_object_id_, what));" << std::endl;
+		cpp_out << "\t\t\t\t" << "return;" << std::endl;
+		cpp_out << "\t\t\t" << "}" << std::endl;
+		if (function.return_type != "void") {
+			cpp_out << "\t\t\t" << function.return_type << " return_value_result_;" << std::endl;
+			cpp_out << "\t\t\t" << "received_.get(return_value_result_);" << std::endl;
+			cpp_out << "\t\t\t" << "promise_->set_value(return_value_result_);" << std::endl;
+		} else {
+			cpp_out << "\t\t\t" << "promise_->set_value();" << std::endl;
+		}
+		cpp_out << "\t\t" << "};" << std::endl;
+}
+
 void generate_proxy_header(const std::string &outputdirectory, ClassDefinition &class_definition) {
 	std::string header_filename = outputdirectory;
 	if (header_filename.size()) {
@@ -1279,6 +1313,7 @@ void generate_proxy_header(const std::string &outputdirectory, ClassDefinition &
 	}
 	header_out << ", saftbus::SignalGroup &signal_group = saftbus::SignalGroup::get_global());" << std::endl;
 	header_out << "\t\t" << "bool signal_dispatch(int interface_no, int signal_no, saftbus::Deserializer &signal_content);" << std::endl;
+	header_out << "\t\t" << "void get_connected_signals(std::vector<std::pair<int,int> > &connected);" << std::endl;
 	for (auto &function: class_definition.exportedfunctions) {
 		// recreate comments from this function
 		for( auto &comment_line: function.comments) {
@@ -1297,6 +1332,27 @@ void generate_proxy_header(const std::string &outputdirectory, ClassDefinition &
 		}
 		header_out << ");" << std::endl;
 	}
+	// asynchronous and batch variants of all functions without output arguments
+	for (auto &function: class_definition.exportedfunctions) {
+		if (has_output_arguments(function)) {
+			continue;
+		}
+		header_out << "\t\t" << "/// @brief asynchronous version of " << function.name << "(), see saftbus::Future" << std::endl;
+		header_out << "\t\t" << "saftbus::Future<" << function.return_type << "> " << function.name << "_async(";
+		for (unsigned i = 0; i < function.argument_list.size(); ++i) {
+			header_out << function.argument_list[i].declaration();
+			if (i != function.argument_list.size()-1) {
+				header_out << ", ";
+			}
+		}
+		header_out << ");" << std::endl;
+		header_out << "\t\t" << "/// @brief add a call of " << function.name << "() to the batch, the result is available after batch.execute()" << std::endl;
+		header_out << "\t\t" << "std::future<" << function.return_type << "> " << function.name << "_batch(saftbus::Batch &batch_";
+		for (unsigned i = 0; i < function.argument_list.size(); ++i) {
+			header_out << ", " << function.argument_list[i].declaration();
+		}
+		header_out << ");" << std::endl;
+	}
 
 	// signals
 	for (auto &signal: class_definition.exportedsignals) {
@@ -1428,6 +1484,22 @@ void generate_proxy_implementation(const std::string &outputdirectory, ClassDefi
 	}
 	cpp_out << "\t\t"     <<   "return false;" << std::endl;
 	cpp_out << "\t"     << "}" << std::endl;
+	cpp_out << "\t"     << "void " << class_definition.name << "_Proxy::get_connected_signals(std::vector<std::pair<int,int> > &connected) {" << std::endl;
+	for (unsigned signal_no = 0; signal_no < class_definition.exportedsignals.size(); ++signal_no) {
+		auto &signal = class_definition.exportedsignals[signal_no];
+		if (signal.sigc_signal) {
+			cpp_out << "\t\t" << "if (!" << signal.name << ".empty()) ";
+		} else {
+			cpp_out << "\t\t" << "if (" << signal.name << ") ";
+		}
+		cpp_out << "connected.push_back(std::make_pair(interface_no, " << signal_no << "));" << std::endl;
+	}
+	for (auto & base: class_definition.direct_bases) {
+		if (base->has_exports()) {
+			cpp_out << "\t\t"   <<   base->name << "_Proxy::get_connected_signals(connected);" << std::endl;
+		}
+	}
+	cpp_out << "\t"     << "}" << std::endl;
 
 
 	for (unsigned function_no  = 0; function_no  < class_definition.exportedfunctions.size(); ++function_no ) {
@@ -1468,7 +1540,7 @@ void generate_proxy_implementation(const std::string &outputdirectory, ClassDefi
 		cpp_out << "\t\t\t" << "std::string what;" << std::endl;
 		cpp_out << "\t\t\t" << "get_received().get(what);" << std::endl;
 		//cpp_out << "\t\t\t" << "throw std::runtime_error(what);" << std::endl;
-		cpp_out << "\t\t\t" << "throw saftbus::Error(what);" << std::endl;
+		cpp_out << "\t\t\t" << "throw_remote_exception(what);" << std::endl;
 		cpp_out << "\t\t" << "}" << std::endl;
 		cpp_out << "\t\t" << "assert(function_result_ == saftbus::FunctionResult::RETURN);" << std::endl;
 		for (unsigned i = 0; i < function.argument_list.size(); ++i) {
@@ -1486,6 +1558,63 @@ void generate_proxy_implementation(const std::string &outputdirectory, ClassDefi
 		cpp_out << "\t}" << std::endl;
 	}
 
+	// The asynchronous variants send a tagged request and return immediately. 
+	// The reply is unpacked into a promise when the ClientConnection reads it.
+	for (unsigned function_no  = 0; function_no  < class_definition.exportedfunctions.size(); ++function_no ) {
+		auto &function = class_definition.exportedfunctions[function_no];
+		if (has_output_arguments(function)) {
+			continue;
+		}
+		cpp_out << "\t" << "saftbus::Future<" << function.return_type << "> " << class_definition.name << "_Proxy::" << function.name << "_async(";
+		for (unsigned i = 0; i < function.argument_list.size(); ++i) {
+			cpp_out << function.argument_list[i].definition();
+			if (i != function.argument_list.size()-1) {
+				cpp_out << ", ";
+			}
+		}
+		cpp_out << "\t) {" << std::endl;
+		cpp_out << "\t\t" << "std::lock_guard<std::mutex> lock(get_proxy_mutex());" << std::endl;
+		cpp_out << "\t\t" << "auto promise_ = std::make_shared<std::promise<" << function.return_type << "> >();" << std::endl;
+		cpp_out << "\t\t" << "saftbus::Future<" << function.return_type << "> future_(get_connection(), get_connection().begin_async_call(get_send()), promise_->get_future());" << std::endl;
+		cpp_out << "\t\t" << "get_send().put(get_saftbus_object_id());" << std::endl;
+		cpp_out << "\t\t" << "get_send().put(interface_no);" << std::endl;
+		cpp_out << "\t\t" << "get_send().put(" << function_no  << "); // function_no" << std::endl;
+		for (unsigned i = 0; i < function.argument_list.size(); ++i) {
+			cpp_out << "\t\t" << "get_send().put(" << function.argument_list[i].name << ");" << std::endl;
+		}
+		generate_reply_handler(cpp_out, function);
+		cpp_out << "\t\t" << "if (get_connection().send_async_call(get_send(), future_.get_request_id(), on_reply_) <= 0) {" << std::endl;
+		cpp_out << "\t\t\t" << "throw saftbus::Error(\"cannot send asynchronous call of " << function.name << "\");" << std::endl;
+		cpp_out << "\t\t" << "}" << std::endl;
+		cpp_out << "\t\t" << "return future_;" << std::endl;
+		cpp_out << "\t}" << std::endl;
+	}
+
+	// The batch variants add the call to a saftbus::Batch, the reply is unpacked in Batch::execute.
+	for (unsigned function_no  = 0; function_no  < class_definition.exportedfunctions.size(); ++function_no ) {
+		auto &function = class_definition.exportedfunctions[function_no];
+		if (has_output_arguments(function)) {
+			continue;
+		}
+		cpp_out << "\t" << "std::future<" << function.return_type << "> " << class_definition.name << "_Proxy::" << function.name << "_batch(saftbus::Batch &batch_";
+		for (unsigned i = 0; i < function.argument_list.size(); ++i) {
+			cpp_out << ", " << function.argument_list[i].definition();
+		}
+		cpp_out << "\t) {" << std::endl;
+		cpp_out << "\t\t" << "auto promise_ = std::make_shared<std::promise<" << function.return_type << "> >();" << std::endl;
+		cpp_out << "\t\t" << "saftbus::Serializer call_(64);" << std::endl;
+		cpp_out << "\t\t" << "call_.put(get_saftbus_object_id());" << std::endl;
+		cpp_out << "\t\t" << "call_.put(interface_no);" << std::endl;
+		cpp_out << "\t\t" << "call_.put(" << function_no  << "); // function_no" << std::endl;
+		for (unsigned i = 0; i < function.argument_list.size(); ++i) {
+			cpp_out << "\t\t" << "call_.put(" << function.argument_list[i].name << ");" << std::endl;
+		}
+		generate_reply_handler(cpp_out, function);
+		cpp_out << "\t\t" << "batch_.add(call_, on_reply_);" << std::endl;
+		cpp_out << "\t\t" << "return promise_->get_future();" << std::endl;
+		cpp_out << "\t}" << std::endl;
+	}
+
 	cpp_out << std::endl;
 	cpp_out << "}" << std::endl;
 	cpp_out << std::endl;
@@ -20,12 +20,20 @@
 
 #include "client.hpp"
 #include "saftbus.hpp"
+#include "signal_ring.hpp"
 #include "error.hpp"
 
 #include <sstream>
 #include <iostream>
 #include <mutex>
+#include <set>
+#include <cstring>
+#include <unordered_map>
+#include <deque>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <algorithm>
 
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -33,6 +41,8 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
 #include <poll.h>
 
 namespace saftbus {
@@ -43,14 +53,31 @@ namespace saftbus {
 		static std::mutex base_socket_mutex;
 		std::mutex fd_mutex;
 		std::mutex connection_mutex;
+		// tagged requests (see begin_async_call)
+		std::atomic<uint32_t> next_request_id;
+		std::deque<uint32_t> outstanding; // request ids in the order in which they were sent
+		std::unordered_map<uint32_t, std::function<void(Deserializer&)> > reply_handlers;
+		Deserializer async_received;
+		size_t max_outstanding;
+		int receive_async_reply(int timeout_ms);
 	};
 	std::mutex ClientConnection::Impl::base_socket_mutex;
 
+	static size_t max_pending_calls_from_env() {
+		const char *max_env = getenv("SAFTBUS_MAX_PENDING_CALLS");
+		if (max_env == nullptr) {
+			return 64;
+		}
+		return std::max(1ul, strtoul(max_env, nullptr, 0));
+	}
+
 
 	ClientConnection::ClientConnection(const std::string &socket_name) 
 		: d(new Impl)
 	{
 		std::lock_guard<std::mutex> lock1(d->base_socket_mutex);
+		d->next_request_id = 0;
+		d->max_outstanding = max_pending_calls_from_env();
 
 		std::ostringstream msg;
 		// msg << "ClientConnection constructor : ";
@@ -130,6 +157,13 @@ namespace saftbus {
 	}
 	int ClientConnection::receive(Deserializer &deserializer, int timeout_ms)
 	{
+		// the server answers in order: replies to tagged requests that were sent earlier come first
+		while (!d->outstanding.empty()) {
+			int result = d->receive_async_reply(timeout_ms);
+			if (result <= 0) {
+				return result;
+			}
+		}
 		std::lock_guard<std::mutex> lock(d->fd_mutex);
 		int result;
 		d->pfd.events = POLLIN | POLLHUP;
@@ -157,6 +191,130 @@ namespace saftbus {
 		return 0;
 	}
 
+	uint32_t ClientConnection::begin_async_call(Serializer &serializer) {
+		uint32_t request_id = d->next_request_id++;
+		serializer.put(async_call_object_id);
+		serializer.put(request_id);
+		return request_id;
+	}
+
+	int ClientConnection::send_async_call(Serializer &serializer, uint32_t request_id, std::function<void(Deserializer&)> on_reply) {
+		std::lock_guard<std::mutex> lock(d->connection_mutex);
+		// don't let the replies pile up in the socket, the server would block when writing them
+		while (d->outstanding.size() >= d->max_outstanding) {
+			int result = d->receive_async_reply(-1);
+			if (result <= 0) {
+				serializer.put_init();
+				return result;
+			}
+		}
+		d->reply_handlers[request_id] = std::move(on_reply);
+		d->outstanding.push_back(request_id);
+		int result = send(serializer);
+		if (result <= 0) {
+			serializer.put_init();
+			d->reply_handlers.erase(request_id);
+			d->outstanding.pop_back();
+		}
+		return result;
+	}
+
+	void ClientConnection::wait_for_reply(uint32_t request_id) {
+		std::lock_guard<std::mutex> lock(d->connection_mutex);
+		while (d->reply_handlers.find(request_id) != d->reply_handlers.end()) {
+			if (d->receive_async_reply(-1) <= 0) {
+				throw saftbus::Error("connection lost while waiting for the reply to an asynchronous call");
+			}
+		}
+	}
+
+	// Read one reply to a tagged request and deliver it. The caller holds the connection_mutex.
+	int ClientConnection::Impl::receive_async_reply(int timeout_ms) {
+		{
+			std::lock_guard<std::mutex> lock(fd_mutex);
+			pfd.events = POLLIN | POLLHUP;
+			int result;
+			if ((result = poll(&pfd, 1, timeout_ms)) <= 0) {
+				return result;
+			}
+			if (!(pfd.revents & POLLIN) || !async_received.read_from(pfd.fd)) {
+				return -1;
+			}
+		}
+		uint32_t request_id;
+		async_received.get(request_id);
+		auto position = std::find(outstanding.begin(), outstanding.end(), request_id);
+		if (position != outstanding.end()) {
+			outstanding.erase(position);
+		}
+		auto handler = reply_handlers.find(request_id);
+		if (handler != reply_handlers.end()) {
+			auto on_reply = std::move(handler->second);
+			reply_handlers.erase(handler);
+			on_reply(async_received);
+		}
+		return 1;
+	}
+
+	/////////////////////////////
+	/////////////////////////////
+	/////////////////////////////
+
+	struct Batch::Impl {
+		std::vector<std::vector<char> > calls;
+		std::vector<std::function<void(Deserializer&)> > result_handlers;
+		Serializer   send;
+		Deserializer received;
+	};
+
+	Batch::Batch() 
+		: d(new Impl)
+	{
+	}
+	Batch::~Batch() = default;
+
+	void Batch::add(const Serializer &call, std::function<void(Deserializer&)> on_result)
+	{
+		d->calls.push_back(call.get_data());
+		d->result_handlers.push_back(std::move(on_result));
+	}
+
+	void Batch::execute()
+	{
+		if (d->calls.empty()) {
+			return;
+		}
+		d->send.put(batch_call_object_id);
+		d->send.put(static_cast<uint32_t>(d->calls.size()));
+		for (auto &call: d->calls) {
+			d->send.put(call);
+		}
+		d->calls.clear();
+		std::vector<std::function<void(Deserializer&)> > result_handlers;
+		result_handlers.swap(d->result_handlers);
+
+		if (Proxy::get_connection().atomic_send_and_receive(d->send, d->received) <= 0) {
+			throw saftbus::Error("Batch cannot exchange data with server");
+		}
+		uint32_t num_results;
+		d->received.get(num_results);
+		if (num_results != result_handlers.size()) {
+			throw saftbus::Error("Batch received wrong number of results");
+		}
+		std::vector<char> buffer;
+		Deserializer result;
+		for (auto &on_result: result_handlers) {
+			d->received.get(buffer);
+			result.read_from_buffer(buffer.data(), buffer.size());
+			on_result(result);
+		}
+	}
+
+	size_t Batch::size() const
+	{
+		return d->calls.size();
+	}
+
 	/////////////////////////////
 	/////////////////////////////
 	/////////////////////////////
@@ -166,9 +324,25 @@ namespace saftbus {
 		int fd_pair[2];
 		int signal_group_id; // the integer value of the fd on the server side
 		Deserializer received;
-		std::vector<Proxy*> proxies;
+		std::unordered_map<int, std::vector<Proxy*> > proxies; // saftbus_object_id -> all Proxies of this Service object in this SignalGroup
 		std::mutex signal_group_mutex;
 		std::mutex fd_mutex;
+		std::mutex filter_mutex; // keeps signal filter updates for this SignalGroup in order
+		std::unique_ptr<SignalRing> ring; // optional shared memory transport for signals
+		int epoll_fd; // only used with ring: combines socket and eventfd for external event loops
+		unsigned batch_size; // maximum number of records that are received with one recvmmsg call
+		char *batch_buffer;  // batch_size slots of batch_slot_size bytes, mapped on first use
+		std::vector<struct mmsghdr> batch_msgs;
+		std::vector<struct iovec>   batch_iovs;
+		std::vector<char> large_message; // reassembles signals that span several records
+		void unmap_batch_buffer();
+		int receive_batch(int &dispatched);
+		int wait_for_signal_batch(int timeout_ms);
+		bool attach_ring(ClientConnection &connection, Serializer &send, Deserializer &received);
+		int read_from_socket();
+		int wait_for_one_signal_ring(int timeout_ms);
+		void dispatch();
+		bool get_signal_filter(int saftbus_object_id, std::vector<int> &interface_nos, std::vector<int> &signal_nos);
 	};
 
 	struct Proxy::Impl {
@@ -182,11 +356,38 @@ namespace saftbus {
 		SignalGroup *signal_group;
 		std::vector<std::string>   interface_names;
 		std::map<std::string, int> interface_name2no_map;
+		bool signal_filter; // true if only wanted_signals should be sent by the Service
+		std::set<std::pair<int,int> > wanted_signals; // (interface_no, signal_no)
+		bool call_only; // not registered at the server, no signals (see SignalGroup::none)
 	};
 	std::shared_ptr<ClientConnection> Proxy::Impl::connection;
 	std::mutex                        Proxy::Impl::connection_mutex;
 
+	// A record is at most 100000 bytes long (see write_all). The slot size is rounded up to full pages.
+	static const size_t batch_slot_size = 102400;
+
+	static unsigned signal_batch_size_from_env() {
+		const char *size_env = getenv("SAFTBUS_SIGNAL_BATCH_SIZE");
+		if (size_env == nullptr) {
+			return 64;
+		}
+		return strtoul(size_env, nullptr, 0);
+	}
+
+	static size_t signal_ring_size_from_env() {
+		const char *size_env = getenv("SAFTBUS_SIGNAL_RING_SIZE");
+		if (size_env == nullptr) {
+			return 0;
+		}
+		return strtoul(size_env, nullptr, 0);
+	}
+
 	SignalGroup::SignalGroup() 
+		: SignalGroup(signal_ring_size_from_env())
+	{
+	}
+
+	SignalGroup::SignalGroup(size_t signal_ring_size) 
 		: d(new Impl)
 	{
 		// std::cerr << "SignalGroup constructor" << std::endl;
@@ -199,11 +400,27 @@ namespace saftbus {
 		d->pfd.fd = d->fd_pair[1];
 		d->pfd.events = POLLIN;
 		d->signal_group_id = -1;
+		d->epoll_fd = -1;
+		d->batch_size = signal_batch_size_from_env();
+		d->batch_buffer = nullptr;
+		if (signal_ring_size > 0) {
+			d->ring.reset(new SignalRing(signal_ring_size));
+			if (!d->ring->valid()) {
+				// fall back to the socket 
+				d->ring.reset();
+			}
+		}
 	}
 
-	SignalGroup::~SignalGroup() = default;
+	SignalGroup::~SignalGroup() 
+	{
+		if (d->epoll_fd != -1) {
+			close(d->epoll_fd);
+		}
+		d->unmap_batch_buffer();
+	}
 
-	int SignalGroup::register_proxy(Proxy *proxy) 
+	int SignalGroup::register_proxy(Proxy * /*proxy*/) 
 	{
 		std::lock_guard<std::mutex> lock(d->signal_group_mutex);
 		// send one of the two socket ends to the server
@@ -220,20 +437,89 @@ namespace saftbus {
 				throw saftbus::Error("SignalGroup::register_proxy cannot send file descriptor to server");
 			}
 		} 
-		d->proxies.push_back(proxy);
 		return 0;
 	}
 
+	// Hand the shared memory and the eventfd of the ring over to the server.
+	// This is called once, right after the server told us the id of our signal socket.
+	// If the server rejects the ring, the ring is discarded and signals keep going through the socket.
+	bool SignalGroup::Impl::attach_ring(ClientConnection &connection, Serializer &send, Deserializer &received)
+	{
+		unsigned container_service_object_id = 1;
+		int interface_no = 0; // Container_Service has only 1 interface with interface_no 0
+		int function_no = 7; // function_no 7 is attach_signal_ring
+		send.put(container_service_object_id);
+		send.put(interface_no);
+		send.put(function_no);
+		send.put(signal_group_id);
+		bool result = false;
+		if (connection.send(send) > 0 &&
+			sendfd(connection.d->pfd.fd, ring->get_memfd())   > 0 &&
+			sendfd(connection.d->pfd.fd, ring->get_eventfd()) > 0 &&
+			connection.receive(received) > 0) {
+			saftbus::FunctionResult function_result;
+			received.get(function_result);
+			if (function_result == saftbus::FunctionResult::RETURN) {
+				received.get(result);
+			}
+		}
+		if (result) {
+			epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+			struct epoll_event ev = {};
+			ev.events = EPOLLIN;
+			ev.data.fd = pfd.fd;
+			epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pfd.fd, &ev);
+			ev.data.fd = ring->get_eventfd();
+			epoll_ctl(epoll_fd, EPOLL_CTL_ADD, ring->get_eventfd(), &ev);
+		} else {
+			ring.reset();
+		}
+		return result;
+	}
+
 	void SignalGroup::unregister_proxy(Proxy *proxy) 
 	{
 		std::lock_guard<std::mutex> lock(d->signal_group_mutex);
 		// std::cerr << "unregister_proxy" << std::endl;
-		d->proxies.erase(std::remove(d->proxies.begin(), d->proxies.end(), proxy), d->proxies.end());
+		auto found = d->proxies.find(proxy->d->saftbus_object_id);
+		if (found != d->proxies.end()) {
+			auto &proxies = found->second;
+			proxies.erase(std::remove(proxies.begin(), proxies.end(), proxy), proxies.end());
+			if (proxies.empty()) {
+				d->proxies.erase(found);
+			}
+		}
+	}
+
+	// Combine the signal filters of all Proxies of one Service object in this SignalGroup.
+	// Return false if at least one of them wants all signals (or if there is no Proxy left).
+	bool SignalGroup::Impl::get_signal_filter(int saftbus_object_id, std::vector<int> &interface_nos, std::vector<int> &signal_nos)
+	{
+		std::lock_guard<std::mutex> lock(signal_group_mutex);
+		auto found = proxies.find(saftbus_object_id);
+		if (found == proxies.end()) {
+			return false;
+		}
+		std::set<std::pair<int,int> > wanted_signals;
+		for (auto &proxy: found->second) {
+			if (!proxy->d->signal_filter) {
+				return false;
+			}
+			wanted_signals.insert(proxy->d->wanted_signals.begin(), proxy->d->wanted_signals.end());
+		}
+		for (auto &wanted: wanted_signals) {
+			interface_nos.push_back(wanted.first);
+			signal_nos.push_back(wanted.second);
+		}
+		return true;
 	}
 
 
 	int SignalGroup::get_fd()
 	{
+		if (d->epoll_fd != -1) {
+			return d->epoll_fd;
+		}
 		return d->pfd.fd;
 	}
 
@@ -246,6 +532,10 @@ namespace saftbus {
 	int SignalGroup::wait_for_signal(int timeout_ms)
 	{
 		// std::cerr << "wait_for_signal(" << timeout_ms << ")" << std::endl;
+		if (d->batch_size > 1 && !d->ring) {
+			std::lock_guard<std::mutex> fd_lock(d->fd_mutex);
+			return d->wait_for_signal_batch(timeout_ms);
+		}
 		int result = wait_for_one_signal(timeout_ms);
 		if (result >= 0) {
 			// there was a signal, timeout was not hit. 
@@ -256,6 +546,202 @@ namespace saftbus {
 		return result;
 	}
 
+	// distribute the content of received to all proxies with matching object id
+	void SignalGroup::Impl::dispatch()
+	{
+		int saftbus_object_id;
+		int interface_no;
+		int signal_no;
+		received.get(saftbus_object_id);
+		received.get(interface_no);
+		received.get(signal_no);
+		std::lock_guard<std::mutex> lock(signal_group_mutex);
+		auto found = proxies.find(saftbus_object_id);
+		if (found == proxies.end()) {
+			return;
+		}
+		auto &matching_proxies = found->second;
+		if (matching_proxies.size() == 1) {
+			// no need to save and restore the Deserializer if there is only one receiver
+			matching_proxies[0]->signal_dispatch(interface_no, signal_no, received);
+			return;
+		}
+		for (auto &proxy: matching_proxies) {
+			// std::cerr << "proxy object id = " << proxy->d->saftbus_object_id << "  signal_group_id = " << proxy->d->signal_group_id << std::endl;
+			received.save();
+			proxy->signal_dispatch(interface_no, signal_no, received);
+			received.restore();
+		}
+	}
+
+	void SignalGroup::set_batch_size(unsigned batch_size)
+	{
+		std::lock_guard<std::mutex> fd_lock(d->fd_mutex);
+		d->unmap_batch_buffer();
+		d->batch_size = batch_size;
+	}
+
+	void SignalGroup::Impl::unmap_batch_buffer()
+	{
+		if (batch_buffer != nullptr) {
+			munmap(batch_buffer, batch_size*batch_slot_size);
+			batch_buffer = nullptr;
+		}
+	}
+
+	// Receive up to batch_size records with one recvmmsg call and dispatch the contained signals in order.
+	// Return the number of received records (0 if nothing was pending), or -1 in case of failure.
+	// The number of dispatched signals is added to dispatched (a large signal spans several records).
+	int SignalGroup::Impl::receive_batch(int &dispatched)
+	{
+		if (batch_buffer == nullptr) {
+			// Every slot can hold the largest possible record, but only the pages 
+			// that are actually written by the kernel will use physical memory.
+			void *memory = mmap(nullptr, batch_size*batch_slot_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+			if (memory == MAP_FAILED) {
+				std::ostringstream msg;
+				msg << "cannot map signal batch buffer: " << strerror(errno);
+				throw saftbus::Error(msg.str());
+			}
+			batch_buffer = static_cast<char*>(memory);
+			batch_msgs.resize(batch_size);
+			batch_iovs.resize(batch_size);
+			for (unsigned i = 0; i < batch_size; ++i) {
+				batch_iovs[i].iov_base = batch_buffer + i*batch_slot_size;
+				batch_iovs[i].iov_len  = batch_slot_size;
+				memset(&batch_msgs[i], 0, sizeof(batch_msgs[i]));
+				batch_msgs[i].msg_hdr.msg_iov    = &batch_iovs[i];
+				batch_msgs[i].msg_hdr.msg_iovlen = 1;
+			}
+		}
+		int n = recvmmsg(pfd.fd, &batch_msgs[0], batch_size, MSG_DONTWAIT, nullptr);
+		if (n < 0) {
+			return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+		}
+		for (int i = 0; i < n; ++i) {
+			char *record = batch_buffer + i*batch_slot_size;
+			int length = batch_msgs[i].msg_len;
+			if (length < (int)sizeof(int)) {
+				return -1; // the server closed the socket
+			}
+			int size;
+			memcpy(&size, record, sizeof(size));
+			int payload = length - sizeof(size);
+			if (payload >= size) {
+				received.read_from_buffer(record + sizeof(size), size);
+			} else {
+				// the rest of a large signal follows in additional records
+				large_message.resize(size);
+				memcpy(&large_message[0], record + sizeof(size), payload);
+				while (payload < size && i+1 < n) {
+					++i;
+					memcpy(&large_message[payload], batch_buffer + i*batch_slot_size, batch_msgs[i].msg_len);
+					payload += batch_msgs[i].msg_len;
+				}
+				if (payload < size && read_all(pfd.fd, &large_message[payload], size-payload) < size-payload) {
+					return -1;
+				}
+				received.read_from_buffer(&large_message[0], size);
+			}
+			dispatch();
+			++dispatched;
+		}
+		return n;
+	}
+
+	// Same as wait_for_signal, but all pending signals are pulled from the socket in batches.
+	// Return the number of dispatched signals (0 on timeout), or -1 in case of failure.
+	int SignalGroup::Impl::wait_for_signal_batch(int timeout_ms)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+		for (;;) {
+			int result = poll(&pfd, 1, timeout_ms);
+			if (result <= 0) {
+				return result;
+			}
+			int dispatched = 0;
+			for (;;) {
+				int n = receive_batch(dispatched);
+				if (n < 0) {
+					if (pfd.revents & POLLHUP) {
+						throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Service hung up"); 
+					}
+					return -1;
+				}
+				if (n < (int)batch_size) {
+					break; // nothing more is pending
+				}
+			}
+			if (dispatched > 0) {
+				return dispatched;
+			}
+			// poll reported the socket as readable, but recvmmsg found nothing (EAGAIN).
+			// That is no timeout, wait again for the remaining time.
+			if (timeout_ms > 0) {
+				auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+				timeout_ms = std::max(0, static_cast<int>(remaining.count()));
+			}
+			if (timeout_ms == 0) {
+				return 0;
+			}
+		}
+	}
+
+	// read and dispatch one signal from the socket after poll reported an event in pfd.revents
+	int SignalGroup::Impl::read_from_socket()
+	{
+		if (pfd.revents & (POLLIN|POLLHUP) ) {
+			bool result = received.read_from(pfd.fd);
+			if (!result) {
+				if (pfd.revents & POLLHUP) {
+					throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Service hung up"); 
+				}
+				return -1;
+			} 
+			dispatch();
+		}
+		if (pfd.revents & POLLHUP) {
+			assert(false); // did the server crash? this should never happen
+		}
+		return 1;
+	}
+
+	// Same as wait_for_one_signal, but signals are taken from the ring if possible.
+	// The socket is still checked because it carries signals that were emitted before the 
+	// ring was attached or that are too large for the ring, and it reports if the server hung up.
+	int SignalGroup::Impl::wait_for_one_signal_ring(int timeout_ms)
+	{
+		for (;;) {
+			if (ring->pop(received)) {
+				dispatch();
+				if (!ring->park()) {
+					// more signals are pending, make sure that an external event loop comes back for them
+					ring->notify();
+				}
+				return 1;
+			}
+			struct pollfd pfds[2];
+			pfds[0].fd = pfd.fd;
+			pfds[0].events = pfd.events;
+			pfds[1].fd = ring->get_eventfd();
+			pfds[1].events = POLLIN;
+			if (!ring->park()) {
+				continue; // a signal arrived after the ring was found empty
+			}
+			int result = poll(pfds, 2, timeout_ms);
+			if (result <= 0) {
+				return result; // timeout or error (the ring stays parked)
+			}
+			if (pfds[1].revents & POLLIN) {
+				ring->unpark();
+			}
+			if (pfds[0].revents) {
+				pfd.revents = pfds[0].revents;
+				return read_from_socket();
+			}
+		}
+	}
+
 	// Wait for a singal signal to arrive. Don't wait more than timeout_ms milliseconds.
 	// Return value:
 	//   > 0 if a signal was received
@@ -264,41 +750,13 @@ namespace saftbus {
 	int SignalGroup::wait_for_one_signal(int timeout_ms)
 	{
 		// std::cerr << "wait_for_one_signal(" << timeout_ms << ") on fd " << d->pfd.fd << std::endl;
-		int result;
-		{
-			std::lock_guard<std::mutex> fd_lock(d->fd_mutex);
-			result = poll(&d->pfd, 1, timeout_ms);
-			if (result > 0) {
-				if (d->pfd.revents & (POLLIN|POLLHUP) ) {
-					bool result = d->received.read_from(d->pfd.fd);
-					if (!result) {
-						if (d->pfd.revents & POLLHUP) {
-							throw saftbus::Error(saftbus::Error::INVALID_ARGS, "Service hung up"); 
-						}
-						return -1;
-					} 
-					int saftbus_object_id;
-					int interface_no;
-					int signal_no;
-					d->received.get(saftbus_object_id);
-					d->received.get(interface_no);
-					d->received.get(signal_no);
-					{
-						std::lock_guard<std::mutex> lock(d->signal_group_mutex);
-						for (auto &proxy: d->proxies) {
-							// std::cerr << "proxy object id = " << proxy->d->saftbus_object_id << "  signal_group_id = " << proxy->d->signal_group_id << std::endl;
-							if (proxy->d->saftbus_object_id == saftbus_object_id) {
-								d->received.save();
-								proxy->signal_dispatch(interface_no, signal_no, d->received);
-								d->received.restore();
-							}
-						}
-					}
-				}
-				if (d->pfd.revents & POLLHUP) {
-					assert(false); // did the server crash? this should never happen
-				}
-			}
+		std::lock_guard<std::mutex> fd_lock(d->fd_mutex);
+		if (d->ring) {
+			return d->wait_for_one_signal_ring(timeout_ms);
+		}
+		int result = poll(&d->pfd, 1, timeout_ms);
+		if (result > 0) {
+			return d->read_from_socket();
 		}
 		return result;
 	}
@@ -307,6 +765,100 @@ namespace saftbus {
 		static SignalGroup signal_group;
 		return signal_group;
 	}
+	SignalGroup& SignalGroup::none()
+	{
+		static SignalGroup signal_group(0);
+		return signal_group;
+	}
+
+	// object path -> saftbus object id and interface numbers, shared by all Proxies of the process.
+	// Every successful Proxy registration fills it, call-only Proxies are created from it.
+	// Entries are dropped if the object is removed through Container_Proxy::remove_object, 
+	// if a lookup doesn't find the object path, or if a call doesn't find the object id.
+	class ObjectPathCache {
+	public:
+		bool find(const std::string &object_path, const std::vector<std::string> &interface_names, int &saftbus_object_id, std::map<std::string, int> &interface_name2no_map) {
+			std::lock_guard<std::mutex> lock(mutex);
+			auto entry = entries.find(object_path);
+			if (entry == entries.end()) {
+				return false;
+			}
+			for (auto &interface_name: interface_names) {
+				if (entry->second.interface_name2no_map.find(interface_name) == entry->second.interface_name2no_map.end()) {
+					return false;
+				}
+			}
+			saftbus_object_id     = entry->second.saftbus_object_id;
+			interface_name2no_map = entry->second.interface_name2no_map;
+			return true;
+		}
+		void insert(const std::string &object_path, int saftbus_object_id, const std::map<std::string, int> &interface_name2no_map) {
+			std::lock_guard<std::mutex> lock(mutex);
+			auto &entry = entries[object_path];
+			if (entry.saftbus_object_id != saftbus_object_id) {
+				entry.saftbus_object_id = saftbus_object_id;
+				entry.interface_name2no_map.clear();
+			}
+			entry.interface_name2no_map.insert(interface_name2no_map.begin(), interface_name2no_map.end());
+		}
+		// remove the object path and all object paths below it (removing an object removes its children)
+		void erase_object_path(const std::string &object_path) {
+			std::lock_guard<std::mutex> lock(mutex);
+			for (auto it = entries.begin(); it != entries.end();) {
+				if (it->first == object_path || (it->first.size() > object_path.size() && it->first[object_path.size()] == '/' && it->first.compare(0, object_path.size(), object_path) == 0)) {
+					it = entries.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+		void erase_object_id(int saftbus_object_id) {
+			std::lock_guard<std::mutex> lock(mutex);
+			for (auto it = entries.begin(); it != entries.end();) {
+				if (it->second.saftbus_object_id == saftbus_object_id) {
+					it = entries.erase(it);
+				} else {
+					++it;
+				}
+			}
+		}
+	private:
+		struct Entry {
+			Entry() : saftbus_object_id(0) {}
+			int saftbus_object_id;
+			std::map<std::string, int> interface_name2no_map;
+		};
+		std::mutex mutex;
+		std::unordered_map<std::string, Entry> entries;
+	};
+	static ObjectPathCache& object_path_cache()
+	{
+		static ObjectPathCache cache;
+		return cache;
+	}
+
+	// throw if the server couldn't resolve the object path
+	static void check_saftbus_object_id(int saftbus_object_id, const std::string &object_path, const std::vector<std::string> &interface_names, const std::map<std::string, int> &interface_name2no_map)
+	{
+		// if we get saftbus_object_id=0, the object path was not found
+		if (saftbus_object_id == 0) {
+			object_path_cache().erase_object_path(object_path);
+			std::ostringstream msg;
+			msg << "object path \"" << object_path << "\" not found";
+			throw saftbus::Error(msg.str());
+		}
+		// if we get saftbus_object_id=-1, the object path was found found bu one of the requested interfaces is not implemented
+		if (saftbus_object_id == -1) { 
+			std::ostringstream msg;
+			msg << "object \"" << object_path << "\" does not implement requested interfaces: ";
+			for (auto &interface_name: interface_names) {
+				if (interface_name2no_map.find(interface_name) == interface_name2no_map.end()) {
+					msg << "\""<< interface_name << "\"" << std::endl;
+				}
+			}
+			throw saftbus::Error(msg.str());
+		}
+	}
 
 
 	/////////////////////////////
@@ -318,6 +870,13 @@ namespace saftbus {
 	{
 		// std::cerr << "Proxy constructor for " << object_path << std::endl;
 		d->signal_group = &signal_group;
+		d->signal_filter = false;
+		d->call_only = (&signal_group == &SignalGroup::none());
+		if (d->call_only) {
+			d->client_id = d->signal_group_id = -1;
+			lookup_object(object_path, interface_names);
+			return;
+		}
 		// the Proxy constructor calls the server  
 		// with object_id = 1 (the Container_Service)
 		unsigned container_service_object_id = 1;
@@ -346,29 +905,47 @@ namespace saftbus {
 		d->received.get(d->client_id);
 		d->received.get(d->signal_group_id);
 		d->received.get(d->interface_name2no_map);
-		// if we get saftbus_object_id=0, the object path was not found
-		if (d->saftbus_object_id == 0) {
-			std::ostringstream msg;
-			msg << "object path \"" << object_path << "\" not found";
-			throw saftbus::Error(msg.str());
-		}
-		// if we get saftbus_object_id=-1, the object path was found found bu one of the requested interfaces is not implemented
-		if (d->saftbus_object_id == -1) { 
-			std::ostringstream msg;
-			msg << "object \"" << object_path << "\" does not implement requested interfaces: ";
-			for (auto &interface_name: interface_names) {
-				if (d->interface_name2no_map.find(interface_name) == d->interface_name2no_map.end()) {
-					msg << "\""<< interface_name << "\"" << std::endl;
-				}
-			}
-			throw saftbus::Error(msg.str());
+		check_saftbus_object_id(d->saftbus_object_id, object_path, interface_names, d->interface_name2no_map);
+		object_path_cache().insert(object_path, d->saftbus_object_id, d->interface_name2no_map);
+		{
+			std::lock_guard<std::mutex> lock(signal_group.d->signal_group_mutex);
+			signal_group.d->proxies[d->saftbus_object_id].push_back(this);
 		}
 		if (signal_group.d->signal_group_id == -1) {
 			signal_group.d->signal_group_id = d->signal_group_id;
+			if (signal_group.d->ring) {
+				std::lock_guard<std::mutex> lock(get_client_socket_mutex());
+				signal_group.d->attach_ring(get_connection(), d->send, d->received);
+			}
 		}
 	}
+	// get object id and interface numbers of a call-only Proxy from the cache or (if that fails) from the Container_Service
+	void Proxy::lookup_object(const std::string &object_path, const std::vector<std::string> &interface_names)
+	{
+		if (object_path_cache().find(object_path, interface_names, d->saftbus_object_id, d->interface_name2no_map)) {
+			return;
+		}
+		unsigned container_service_object_id = 1;
+		int interface_no = 0; // Container_Service has only 1 interface with interface_no 0
+		int function_no = 9; // function_no 9 is lookup_object
+		d->send.put(container_service_object_id);
+		d->send.put(interface_no);
+		d->send.put(function_no);
+		d->send.put(object_path);
+		d->send.put(interface_names);
+		if (get_connection().atomic_send_and_receive(d->send, d->received) <= 0) {
+			throw saftbus::Error("Proxy cannot exchange data with server");
+		}
+		d->received.get(d->saftbus_object_id);
+		d->received.get(d->interface_name2no_map);
+		check_saftbus_object_id(d->saftbus_object_id, object_path, interface_names, d->interface_name2no_map);
+		object_path_cache().insert(object_path, d->saftbus_object_id, d->interface_name2no_map);
+	}
 	Proxy::~Proxy()
 	{
+		if (d->call_only) {
+			return; // the server doesn't know about this Proxy
+		}
 		// de-register from server
 		// client connection is shared among threads
 		// only one thread can access the connection at a time
@@ -386,11 +963,76 @@ namespace saftbus {
 			get_connection().send(d->send);
 		}
 		d->signal_group->unregister_proxy(this);
+		// the remaining Proxies of this Service object may want fewer signals now
+		std::lock_guard<std::mutex> filter_lock(d->signal_group->d->filter_mutex);
+		send_signal_filter(d->signal_filter);
 	}
 	bool Proxy::signal_dispatch(int interface_no, int signal_no, Deserializer &signal_content) 
 	{
 		return false;
 	}
+	void Proxy::get_connected_signals(std::vector<std::pair<int,int> > & /*connected*/)
+	{
+	}
+	void Proxy::ignore_unconnected_signals()
+	{
+		if (d->call_only) {
+			return;
+		}
+		std::vector<std::pair<int,int> > connected;
+		get_connected_signals(connected);
+		std::lock_guard<std::mutex> filter_lock(d->signal_group->d->filter_mutex);
+		std::lock_guard<std::mutex> mutex_lock(d->proxy_mutex);
+		bool was_filtered = d->signal_filter;
+		d->wanted_signals = std::set<std::pair<int,int> >(connected.begin(), connected.end());
+		d->signal_filter = true;
+		send_signal_filter(was_filtered);
+	}
+	void Proxy::receive_all_signals()
+	{
+		if (d->call_only) {
+			return;
+		}
+		std::lock_guard<std::mutex> filter_lock(d->signal_group->d->filter_mutex);
+		std::lock_guard<std::mutex> mutex_lock(d->proxy_mutex);
+		bool was_filtered = d->signal_filter;
+		d->signal_filter = false;
+		d->wanted_signals.clear();
+		send_signal_filter(was_filtered);
+	}
+	// Tell the Service which signals the Proxies of this SignalGroup want.
+	// The proxy_mutex and the filter_mutex of the SignalGroup must be locked.
+	void Proxy::send_signal_filter(bool was_filtered)
+	{
+		std::vector<int> interface_nos, signal_nos;
+		bool filter = d->signal_group->d->get_signal_filter(d->saftbus_object_id, interface_nos, signal_nos);
+		if (!filter && !was_filtered) {
+			return; // another Proxy still wants all signals, nothing changes for the Service
+		}
+		d->send.put(1); // 1 is the special object id that adresses the ContainerService wich provides the set_signal_filter method
+		int interface_no = 0;
+		int function_no = 8; // 8 is set_signal_filter
+		d->send.put(interface_no);
+		d->send.put(function_no);
+		d->send.put(d->saftbus_object_id);
+		d->send.put(d->signal_group_id);
+		d->send.put(filter);
+		d->send.put(interface_nos);
+		d->send.put(signal_nos);
+		std::lock_guard<std::mutex> lock(get_client_socket_mutex());
+		get_connection().send(d->send);
+	}
+	void Proxy::throw_remote_exception(const std::string &what)
+	{
+		std::rethrow_exception(remote_exception(d->saftbus_object_id, what));
+	}
+	std::exception_ptr Proxy::remote_exception(int saftbus_object_id, const std::string &what)
+	{
+		if (what == object_not_found_message) {
+			object_path_cache().erase_object_id(saftbus_object_id);
+		}
+		return std::make_exception_ptr(saftbus::Error(what));
+	}
 	SignalGroup& Proxy::get_signal_group()
 	{
 		return *d->signal_group;
@@ -511,6 +1153,7 @@ namespace saftbus {
 		assert(function_result_ == saftbus::FunctionResult::RETURN);
 		bool return_value_result_;
 		get_received().get(return_value_result_);
+		object_path_cache().erase_object_path(object_path);
 		return return_value_result_;
 	}
 	void Container_Proxy::quit(	) {
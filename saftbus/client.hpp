@@ -27,8 +27,13 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <utility>
 #include <mutex>
 #include <algorithm>
+#include <functional>
+#include <future>
+#include <exception>
+#include <chrono>
 
 #include <unistd.h>
 
@@ -68,11 +73,79 @@ namespace saftbus {
 		/// @param timeout return after so many milliseconds even if the data could not be sent.
 		/// @return 0 in case of timeout, >0 in case of success, -1 in case of error
 		int atomic_send_and_receive(Serializer &serializer, Deserializer &deserializer, int timeout_ms = -1);
+
+		/// @brief start a tagged request: put the marker and a new request id into the (empty) serializer
+		///
+		/// The rest of the request (object id, interface_no, function_no, arguments) follows as usual.
+		/// @return the request id, needed for send_async_call
+		uint32_t begin_async_call(Serializer &serializer);
+		/// @brief send a tagged request without waiting for the reply
+		///
+		/// Many tagged requests can be in flight at the same time. on_reply is called with the reply when it is 
+		/// read from the connection, which happens in wait_for_reply or before the reply of a later synchronous call.
+		/// If more than SAFTBUS_MAX_PENDING_CALLS (default 64) requests are in flight, the oldest reply is read first.
+		/// @return 0 in case of timeout, >0 in case of success, -1 in case of error
+		int send_async_call(Serializer &serializer, uint32_t request_id, std::function<void(Deserializer&)> on_reply);
+		/// @brief read replies until the reply for request_id has been delivered. 
+		///
+		/// Throws saftbus::Error if the connection fails.
+		void wait_for_reply(uint32_t request_id);
+	};
+
+	/// @brief The result of an asynchronous call of a Proxy function (the *_async functions generated by saftbus-gen).
+	///
+	/// The request is on its way to the Service when the Future is created. get() waits for the reply. 
+	/// Replies to other outstanding calls that arrive earlier are delivered to their Futures on the way.
+	template<typename T>
+	class Future {
+	public:
+		Future(ClientConnection &c, uint32_t id, std::future<T> r) : connection(&c), request_id(id), result(std::move(r)) {}
+		/// @brief wait for the reply and return the result. Throws saftbus::Error if the remote function threw an exception.
+		T get() {
+			connection->wait_for_reply(request_id);
+			return result.get();
+		}
+		/// @brief true if the reply was already delivered. This doesn't read from the connection.
+		bool ready() const {
+			return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+		}
+		uint32_t get_request_id() const {
+			return request_id;
+		}
+	private:
+		ClientConnection *connection;
+		uint32_t request_id;
+		std::future<T> result;
 	};
 
 
 	class Proxy;
 
+	/// @brief Collects calls of Proxy functions and executes them in one exchange with the server.
+	///
+	/// The *_batch functions generated by saftbus-gen add a call to a Batch and return a std::future for its result.
+	/// execute() sends all calls in one message, saftbusd executes them in order and sends all results back in one message.
+	/// The calls may go to different Service objects. A call that throws doesn't stop the other calls, the exception
+	/// is delivered through its future. Futures of a Batch that was not executed never become ready.
+	///
+	///     saftbus::Batch batch;
+	///     auto count = sink->getActionCount_batch(batch);
+	///     auto late  = sink->getLateCount_batch(batch);
+	///     batch.execute();
+	///     std::cout << count.get() << " " << late.get() << std::endl;
+	class Batch {
+		struct Impl; std::unique_ptr<Impl> d;
+	public:
+		Batch();
+		~Batch();
+		/// @brief add a call (object id, interface_no, function_no, arguments). on_result is called with the reply in execute()
+		void add(const Serializer &call, std::function<void(Deserializer&)> on_result);
+		/// @brief send all calls to the server and deliver the results. Afterwards the Batch is empty and can be reused.
+		void execute();
+		/// @brief number of calls that wait for execute()
+		size_t size() const;
+	};
+
 	/// @brief Manage incoming saftbus signals and distribute them to the connected Proxy objects.
 	///
 	/// Signals from Services are always sent to an instance of SignalGroup, which manages a file descriptor,
@@ -82,14 +155,25 @@ namespace saftbus {
 	/// In some situations (e.g. when independent threads are used), Proxy objects might need their own
 	/// channel for signals. A new SignalGroup can be created and passed to the constructor of Proxy objects in order
 	/// to assign them to this SignalGroup.
+	///
+	/// Optionally, signals can be delivered through a shared memory ring buffer (see saftbus::SignalRing)
+	/// instead of the socket. This removes the kernel copy and the system calls from every signal emission
+	/// and is useful for high signal rates. The socket is kept as fallback, e.g. for signals that are larger 
+	/// than the ring. If the ring cannot be created, all signals go through the socket.
 	class SignalGroup {
 		struct Impl; std::unique_ptr<Impl> d;
 	friend class Proxy;
 	public:
+		/// @brief Use a signal ring if the environment variable SAFTBUS_SIGNAL_RING_SIZE is set to a size in bytes.
 		SignalGroup();
+		/// @param signal_ring_size size of the shared memory ring for signals in bytes. 0 means: use only the socket.
+		SignalGroup(size_t signal_ring_size);
 		~SignalGroup();
 
 		/// @brief used in the Constructor of Proxy objects to connect themselves to this SignalGroup.
+		///
+		/// Sends the signal socket to the server when the first Proxy registers. The Proxy is added to
+		/// the dispatch index of this SignalGroup once the server has told it its saftbus object id.
 		int register_proxy(Proxy *proxy);
 		/// @brief used in the Destructor of Proxy objects to remove themselves from this SignalGroup.
 		void unregister_proxy(Proxy *proxy);
@@ -97,6 +181,9 @@ namespace saftbus {
 		/// @brief Get the file descriptor where the signal are being sent.
 		///
 		/// This function is intended to be used when saftbus signals need to be integrated into an event loop.
+		/// If a signal ring is used, the returned file descriptor is an epoll descriptor that becomes readable 
+		/// when either the socket or the wakeup eventfd of the ring are readable. In both cases, wait_for_signal 
+		/// should be used to process the signals because it drains everything that is pending.
 		int get_fd(); // this can be used to hook the SignalGroup into an event loop
 
 		/// @brief Wait for signal to arrive and return either on timeout, or when a number of signals was dispatcht and there are no more signals in the pipe.
@@ -112,7 +199,25 @@ namespace saftbus {
 		/// @return >0 if a signal was received, 0 if timeout was hit, < 0 in case of failure (e.g. service object was destroyed)
 		int wait_for_one_signal(int timeout_ms = -1);
 
+		/// @brief Set the maximum number of signal messages that wait_for_signal receives with one system call.
+		///
+		/// Signals that arrive in a burst are pulled from the socket in batches (using recvmmsg) and dispatched
+		/// in order. The default is taken from the environment variable SAFTBUS_SIGNAL_BATCH_SIZE (64 if unset). 
+		/// With a batch size of 1, every signal is received with its own system call.
+		void set_batch_size(unsigned batch_size);
+
 		static SignalGroup &get_global();
+
+		/// @brief Pass this to the constructor of a Proxy to create a call-only Proxy.
+		///
+		/// A call-only Proxy doesn't receive any signals and doesn't register itself at the server.
+		/// Its object id and interface numbers come from a process wide cache of object paths, so creating and 
+		/// destroying it costs no exchange with the server if the object path was used before. 
+		/// Otherwise one lookup call is made. Use it for short-lived Proxies that only call functions:
+		///
+		///     auto condition = saftlib::SoftwareCondition_Proxy::create(object_path, saftbus::SignalGroup::none());
+		///     condition->setActive(false);
+		static SignalGroup &none();
 	};
 
 	/// @brief Base class of all Proxy objects.
@@ -135,11 +240,12 @@ namespace saftbus {
 	/// This map available to all Proxy base classes by the method interface_no_from_name.
 	///
 	/// @param object_path is the string that identifies the Service object in the saftbus::Container running on the server side.
-	/// @param signal_group is the SignalGroup over which this Proxy receives its signals.
+	/// @param signal_group is the SignalGroup over which this Proxy receives its signals. SignalGroup::none() creates a call-only Proxy.
 	/// @param interfaces_names is an array of strings with the interface names in text from.
 	class Proxy {
 		struct Impl; std::unique_ptr<Impl> d;
 	friend class SignalGroup;
+	friend class Batch;
 	public:
 		virtual ~Proxy();
 		/// @brief dispatching function which triggers the actual signals (sigc::signal or std::function) based on the interface_no and signal_no
@@ -148,6 +254,20 @@ namespace saftbus {
 		/// @param signal_no    refers to the signal of a given interface. Signals are numbered by their appearance in the source code.
 		virtual bool signal_dispatch(int interface_no, int signal_no, Deserializer &signal_content) = 0;
 
+		/// @brief collect (interface_no, signal_no) of all signals that have a callback connected.
+		///
+		/// Generated by saftbus-gen. The default implementation reports no signals.
+		virtual void get_connected_signals(std::vector<std::pair<int,int> > &connected);
+
+		/// @brief Ask the Service to send only the signals that have a callback connected at the time of this call.
+		///
+		/// All other signals are dropped on the server side before they are written to the socket.
+		/// Call this again after connecting more callbacks. As long as another Proxy in the same SignalGroup 
+		/// for the same Service object receives all signals, the Service keeps sending all signals.
+		void ignore_unconnected_signals();
+		/// @brief Undo ignore_unconnected_signals. This is the default for every new Proxy.
+		void receive_all_signals();
+
 		/// @brief The signal group to which this proxy belongs.
 		/// 
 		/// @return a reference to a SignalGroup object
@@ -181,6 +301,20 @@ namespace saftbus {
 		/// in the Service object. The Proxy constructor has to get this name->number mapping from the
 		/// Service object during the initialization phase (the derived Proxy constructor)
 		int interface_no_from_name(const std::string &interface_name); 
+
+		/// @brief throw saftbus::Error with the exception message that was received from the Service.
+		///
+		/// If the message says that the service object doesn't exist anymore, its object path is removed 
+		/// from the object path cache that is used by call-only Proxies (see SignalGroup::none).
+		[[noreturn]] void throw_remote_exception(const std::string &what);
+
+		/// @brief the exception for the exception message of an asynchronous or batched call.
+		///
+		/// Same as throw_remote_exception, but usable in reply handlers that run after the Proxy was destroyed.
+		static std::exception_ptr remote_exception(int saftbus_object_id, const std::string &what);
+	private:
+		void send_signal_filter(bool was_filtered);
+		void lookup_object(const std::string &object_path, const std::vector<std::string> &interface_names);
 	};
 
 	/// @brief contains all information about the status of a saftbus server.
@@ -221,17 +355,20 @@ namespace saftbus {
 			pid_t process_id;
 			int client_fd;
 			std::map<int,int> signal_fds;
+			std::map<int,uint64_t> dropped_signals; // number of signals that could not be delivered for each signal fd
 			/// @brief custom serializer
 			void serialize(Serializer &ser) const {
 				ser.put(process_id);
 				ser.put(client_fd);
 				ser.put(signal_fds);
+				ser.put(dropped_signals);
 			}
 			/// @brief custom deserializer
 			void deserialize(const Deserializer &des) {
 				des.get(process_id);
 				des.get(client_fd);
 				des.get(signal_fds);
+				des.get(dropped_signals);
 			}
 		};
 		std::vector<ClientInfo> client_infos;
@@ -1,80 +1,144 @@
 #include "configurable_chunck_allocator_rt.hpp"
 
 #include <sstream>
+#include <new>
+
+#include <sys/mman.h>
 
 namespace saftbus
 {
 
-	ChunckAllocatorRT::ChunckAllocatorRT(size_t max_chuncks, size_t chuncksize) 
+	ChunckAllocatorRT::ChunckAllocatorRT(size_t max_chuncks, size_t chuncksize, char *memory) 
 		: MAX_CHUNCKS(max_chuncks)
 		, CHUNCKSIZE(chuncksize)
-		, chuncks    (reinterpret_cast<char*>  (::malloc(max_chuncks*chuncksize)))
-		, backindices(reinterpret_cast<size_t*>(::malloc(max_chuncks*sizeof(size_t))))
-		, indices    (reinterpret_cast<size_t*>(::malloc(max_chuncks*sizeof(size_t))))
-		, allocated_chuncks(0)
+		, chuncks    (memory)
+		, next       (reinterpret_cast<std::atomic<uint32_t>*>(::malloc(max_chuncks*sizeof(std::atomic<uint32_t>))))
+		, head(MAX_CHUNCKS?0:EMPTY)
+		, free_chuncks(MAX_CHUNCKS)
+		, high_water(0)
+		, heap_fallbacks(0)
 	{
+		assert(MAX_CHUNCKS < EMPTY);
 		for (size_t i = 0; i < MAX_CHUNCKS; ++i) {
-			backindices[i] = i;
-			indices[i]     = i;
+			new(&next[i]) std::atomic<uint32_t>(i+1<MAX_CHUNCKS?i+1:EMPTY);
 		}
 	}
 	ChunckAllocatorRT::~ChunckAllocatorRT() {
 		// print_size();
-		::free(indices);
-		::free(backindices);
-		::free(chuncks);
+		::free(next);
 	}
 	char* ChunckAllocatorRT::malloc(size_t size) {
 		assert(size <= CHUNCKSIZE);
-		assert(allocated_chuncks < MAX_CHUNCKS);
-		return &chuncks[indices[allocated_chuncks++]*CHUNCKSIZE];
+		char *ptr = nullptr;
+		malloc_batch(&ptr, 1);
+		return ptr;
 	}
 
 	void ChunckAllocatorRT::free(char* ptr) {
-		assert(allocated_chuncks > 0);
-		assert(contains(ptr));
-		size_t index = (ptr-&chuncks[0])/CHUNCKSIZE;
-
-		size_t &a_idx = indices[backindices[index]];
-		size_t &b_idx = indices[allocated_chuncks-1];
-
-		size_t &a_backidx = backindices[a_idx];
-		size_t &b_backidx = backindices[b_idx];
+		free_batch(&ptr, 1);
+	}
 
-		std::swap(a_idx,     b_idx);
-		std::swap(a_backidx, b_backidx);
+	size_t ChunckAllocatorRT::malloc_batch(char **ptrs, size_t n) {
+		uint64_t old_head = head.load(std::memory_order_acquire);
+		for (;;) {
+			uint32_t first = old_head;
+			if (first == EMPTY) {
+				return 0;
+			}
+			// Walk along the list. If another thread modifies the list in the meantime, 
+			// the values read here may be inconsistent, but then the tag has changed and 
+			// compare_exchange fails.
+			size_t taken = 1;
+			uint32_t rest = next[first].load(std::memory_order_relaxed);
+			while (taken < n && rest != EMPTY) {
+				rest = next[rest].load(std::memory_order_relaxed);
+				++taken;
+			}
+			uint64_t new_head = (((old_head>>32)+1)<<32) | rest;
+			if (head.compare_exchange_weak(old_head, new_head, std::memory_order_acq_rel, std::memory_order_acquire)) {
+				// the chuncks first...rest belong to this thread now
+				uint32_t idx = first;
+				for (size_t i = 0; i < taken; ++i) {
+					ptrs[i] = &chuncks[idx*CHUNCKSIZE];
+					idx = next[idx].load(std::memory_order_relaxed);
+				}
+				size_t used = MAX_CHUNCKS - (free_chuncks.fetch_sub(taken, std::memory_order_relaxed) - taken);
+				size_t max_used = high_water.load(std::memory_order_relaxed);
+				while (used > max_used && !high_water.compare_exchange_weak(max_used, used, std::memory_order_relaxed)) {
+				}
+				return taken;
+			}
+		}
+	}
 
-		--allocated_chuncks;
+	void ChunckAllocatorRT::free_batch(char **ptrs, size_t n) {
+		if (n == 0) {
+			return;
+		}
+		assert(contains(ptrs[0]));
+		uint32_t first = (ptrs[0]-&chuncks[0])/CHUNCKSIZE;
+		uint32_t last  = first;
+		for (size_t i = 1; i < n; ++i) {
+			assert(contains(ptrs[i]));
+			uint32_t idx = (ptrs[i]-&chuncks[0])/CHUNCKSIZE;
+			next[last].store(idx, std::memory_order_relaxed);
+			last = idx;
+		}
+		uint64_t old_head = head.load(std::memory_order_relaxed);
+		for (;;) {
+			next[last].store(static_cast<uint32_t>(old_head), std::memory_order_relaxed);
+			uint64_t new_head = (((old_head>>32)+1)<<32) | first;
+			if (head.compare_exchange_weak(old_head, new_head, std::memory_order_release, std::memory_order_relaxed)) {
+				break;
+			}
+		}
+		free_chuncks.fetch_add(n, std::memory_order_relaxed);
 	}
+
 	void ChunckAllocatorRT::print_size() {
-		std::cerr << "filled: " << allocated_chuncks << "/" << MAX_CHUNCKS << std::endl;
+		std::cerr << "filled: " << MAX_CHUNCKS-free_chuncks << "/" << MAX_CHUNCKS << std::endl;
 	}
 
 	void ChunckAllocatorRT::print_state() {
-		for (size_t i = 0; i < MAX_CHUNCKS; ++i) {
-			std::cerr << std::setw(3) << backindices[i] << " ";
+		// print the free list (not thread safe)
+		for (uint32_t idx = head.load(); idx != EMPTY; idx = next[idx].load()) {
+			std::cerr << std::setw(3) << idx << " ";
 		}
 		std::cerr << std::endl;
-		for (size_t i = 0; i < MAX_CHUNCKS; ++i) {
-			std::cerr << std::setw(3) << indices[i] << " ";
-		}
-		std::cerr << std::endl;
-		for (size_t i = 0; i < allocated_chuncks; ++i) {
-			std::cerr << std::setw(3) << " " << " ";
-		}
-		std::cerr << "  ^" << std::endl;
 	}
 	bool ChunckAllocatorRT::contains(char *ptr) {
 		return (ptr >= &chuncks[0]
 			 && ptr <  &chuncks[MAX_CHUNCKS*CHUNCKSIZE]);
 	}
 	bool ChunckAllocatorRT::full() {
-		return allocated_chuncks == MAX_CHUNCKS;
+		return static_cast<uint32_t>(head.load(std::memory_order_relaxed)) == EMPTY;
 	}
 	bool ChunckAllocatorRT::fits(size_t n) {
 		return n <= CHUNCKSIZE;
 	}
 
+	Allocator *get_allocator();
+
+	namespace {
+		struct Magazine {
+			size_t count;
+			char  *chuncks[Allocator::MAGAZINE_SIZE];
+		};
+		// Set when the thread cache is destroyed. Mallocs and frees that happen after that (in 
+		// destructors of other thread_local objects) go directly to the pools. The flag has no 
+		// destructor, so unlike a member of ThreadCache it can still be read at that time.
+		thread_local bool thread_cache_flushed = false;
+		// Chuncks cached by one thread. When the thread exits, they go back into the shared pools.
+		struct ThreadCache {
+			Magazine magazines[Allocator::MAX_POOLS];
+			~ThreadCache() {
+				get_allocator()->flush_thread_cache();
+				thread_cache_flushed = true;
+			}
+		};
+		thread_local ThreadCache thread_cache;
+	}
+
 
 	Allocator::Allocator() {
 		std::cerr << "configurable chunck allocator" << std::endl;
@@ -83,6 +147,7 @@ namespace saftbus
 			allocator_config_string = "16384.128 1024.1024 64.16384";
 		}
 		heap_allocations = 0;
+		heap_too_large = 0;
 		num_allocators = 0;
 		const char* ptr = allocator_config_string;
 		if (*ptr) num_allocators = 1;
@@ -90,38 +155,104 @@ namespace saftbus
 			if (*ptr == ' ') ++num_allocators;
 			++ptr;
 		}
+		if (num_allocators > MAX_POOLS) {
+			std::cerr << "too many pools in allocator configuration, using only the first " << MAX_POOLS << std::endl;
+			num_allocators = MAX_POOLS;
+		}
+		// All pools are placed in one region. Each pool starts at a page boundary, 
+		// so that the pool of any pointer into the region can be found with a table lookup.
+		size_t max_chuncks[MAX_POOLS];
+		size_t chuncksizes[MAX_POOLS];
+		size_t pool_offsets[MAX_POOLS];
+		region_size = 0;
 		ptr = allocator_config_string;
-		allocators = reinterpret_cast<ChunckAllocatorRT**>(::malloc(num_allocators*sizeof(ChunckAllocatorRT*)));
 		for (size_t i = 0; i < num_allocators; ++i) {
-			int max_chuncks = 0;
-			int chuncksize = 0;
-			sscanf(ptr,"%d.%d",&max_chuncks, &chuncksize);
+			int num = 0;
+			int size = 0;
+			sscanf(ptr,"%d.%d",&num, &size);
+			max_chuncks[i] = num;
+			chuncksizes[i] = (size + GRANULARITY-1) & ~(GRANULARITY-1); // keep all chuncks aligned
 			if (i > 0) {
-				assert(static_cast<int>(allocators[i-1]->MAX_CHUNCKS) > max_chuncks); // later allocators must have fewer chuncks
-				assert(static_cast<int>(allocators[i-1]->CHUNCKSIZE)  < chuncksize); // later allocators must use larger chuncks
+				assert(max_chuncks[i-1] > max_chuncks[i]); // later allocators must have fewer chuncks
+				assert(chuncksizes[i-1] < chuncksizes[i]); // later allocators must use larger chuncks
 			}
-			printf("creating allocator with % 6d chuncks of size % 6d\n", max_chuncks, chuncksize);
-			allocators[i] = new(::malloc(sizeof(ChunckAllocatorRT))) ChunckAllocatorRT(max_chuncks,chuncksize);
+			pool_offsets[i] = region_size;
+			region_size += (max_chuncks[i]*chuncksizes[i] + POOL_ALIGNMENT-1) & ~(POOL_ALIGNMENT-1);
 			while(*ptr) if (*ptr++ == ' ') break; // advance to next pair of numbers
 		}
+		region = nullptr;
+		if (region_size > 0) {
+			void *mem = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (mem == MAP_FAILED) {
+				std::cerr << "cannot reserve " << region_size << " bytes for the allocator, using only the heap" << std::endl;
+				num_allocators = 0;
+				region_size = 0;
+			} else {
+				region = reinterpret_cast<char*>(mem);
+			}
+		}
+		pool_of_page = reinterpret_cast<uint8_t*>(::malloc(region_size/POOL_ALIGNMENT + 1));
+		max_chuncksize = num_allocators ? chuncksizes[num_allocators-1] : 0;
+		size_class = reinterpret_cast<uint8_t*>(::malloc(max_chuncksize/GRANULARITY + 1));
+		allocators = reinterpret_cast<ChunckAllocatorRT**>(::malloc(num_allocators*sizeof(ChunckAllocatorRT*)));
+		size_t smallest_fitting = 0;
+		for (size_t i = 0; i < num_allocators; ++i) {
+			printf("creating allocator with % 6d chuncks of size % 6d\n", static_cast<int>(max_chuncks[i]), static_cast<int>(chuncksizes[i]));
+			allocators[i] = new(::malloc(sizeof(ChunckAllocatorRT))) ChunckAllocatorRT(max_chuncks[i], chuncksizes[i], region + pool_offsets[i]);
+			size_t pool_end = (i+1 < num_allocators) ? pool_offsets[i+1] : region_size;
+			for (size_t page = pool_offsets[i]/POOL_ALIGNMENT; page < pool_end/POOL_ALIGNMENT; ++page) {
+				pool_of_page[page] = i;
+			}
+			for (; smallest_fitting < chuncksizes[i]/GRANULARITY; ++smallest_fitting) {
+				size_class[smallest_fitting] = i;
+			}
+		}
 	}
 	char* Allocator::malloc(size_t n) {
-		for (size_t i = 0; i < num_allocators; ++i) {
-			if (allocators[i]->fits(n) && !allocators[i]->full()) {
-				return allocators[i]->malloc(n);
+		if (num_allocators == 0) { // no pools configured (or the region could not be reserved)
+			heap_allocations.fetch_add(1, std::memory_order_relaxed);
+			return reinterpret_cast<char*>(::malloc(n));
+		}
+		if (n > max_chuncksize) {
+			heap_too_large.fetch_add(1, std::memory_order_relaxed);
+			heap_allocations.fetch_add(1, std::memory_order_relaxed);
+			return reinterpret_cast<char*>(::malloc(n));
+		}
+		size_t first_fit = size_class[n ? (n-1)/GRANULARITY : 0];
+		// if the smallest fitting pool is exhausted, try the larger ones
+		if (thread_cache_flushed) {
+			for (size_t i = first_fit; i < num_allocators; ++i) {
+				if (char *ptr = allocators[i]->malloc(n)) {
+					return ptr;
+				}
+			}
+		} else {
+			ThreadCache &cache = thread_cache;
+			for (size_t i = first_fit; i < num_allocators; ++i) {
+				Magazine &magazine = cache.magazines[i];
+				if (magazine.count == 0) {
+					magazine.count = allocators[i]->malloc_batch(magazine.chuncks, MAGAZINE_BATCH);
+				}
+				if (magazine.count > 0) {
+					return magazine.chuncks[--magazine.count];
+				}
 			}
 		}
-		++heap_allocations;
+		allocators[first_fit]->heap_fallbacks.fetch_add(1, std::memory_order_relaxed);
+		heap_allocations.fetch_add(1, std::memory_order_relaxed);
 		// std::cerr << "heap allocation " << n << std::endl;
 		return reinterpret_cast<char*>(::malloc(n));
 	}
 	std::string Allocator::fillstate() {
 		std::ostringstream msg;
-		msg << "chunksize   used/available" << std::endl;
+		msg << "chunksize   used/available   high-water   heap-fallbacks" << std::endl;
 		for (size_t i = 0; i < num_allocators; ++i) {
-			msg << std::setw(9) << allocators[i]->CHUNCKSIZE << "   " << allocators[i]->allocated_chuncks << "/" << allocators[i]->MAX_CHUNCKS << std::endl;
+			std::ostringstream used;
+			used << allocators[i]->MAX_CHUNCKS-allocators[i]->free_chuncks << "/" << allocators[i]->MAX_CHUNCKS;
+			msg << std::setw(9) << allocators[i]->CHUNCKSIZE << "   " << std::left << std::setw(14) << used.str() << std::right
+			    << std::setw(10) << allocators[i]->high_water << "   " << std::setw(14) << allocators[i]->heap_fallbacks << std::endl;
 		}
-		msg << std::setw(9) << "heap" << "   " << heap_allocations << "/-" << std::endl;
+		msg << std::setw(9) << "heap" << "   " << heap_allocations << "/-" << " (" << heap_too_large << " larger than " << max_chuncksize << ")" << std::endl;
 		return msg.str();
 	}
 
@@ -131,16 +262,37 @@ namespace saftbus
 		// }
 		// std::cerr << "heap: " << heap_allocations << std::endl;
 		// std::cerr << "---------" << std::endl;
-		for (size_t i = 0; i < num_allocators; ++i) {
-			if (allocators[i]->contains(ptr)) {
+		if (ptr == nullptr) {
+			return;
+		}
+		uintptr_t offset = reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(region);
+		if (offset < region_size) {
+			size_t i = pool_of_page[offset/POOL_ALIGNMENT];
+			if (thread_cache_flushed) {
 				allocators[i]->free(ptr);
 				return;
 			}
+			Magazine &magazine = thread_cache.magazines[i];
+			if (magazine.count == MAGAZINE_SIZE) {
+				magazine.count -= MAGAZINE_BATCH;
+				allocators[i]->free_batch(&magazine.chuncks[magazine.count], MAGAZINE_BATCH);
+			}
+			magazine.chuncks[magazine.count++] = ptr;
+			return;
 		}
-		--heap_allocations;
+		heap_allocations.fetch_sub(1, std::memory_order_relaxed);
 		::free(ptr);
 	}
 
+	void Allocator::flush_thread_cache() {
+		ThreadCache &cache = thread_cache;
+		for (size_t i = 0; i < num_allocators; ++i) {
+			Magazine &magazine = cache.magazines[i];
+			allocators[i]->free_batch(magazine.chuncks, magazine.count);
+			magazine.count = 0;
+		}
+	}
+
 
 Allocator *get_allocator() {
 	static Allocator *allocator = new(::malloc(sizeof(*allocator))) Allocator;
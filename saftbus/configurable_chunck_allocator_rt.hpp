@@ -4,7 +4,9 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
 #include <cstdlib>
 #include <cstdio>
@@ -12,37 +14,70 @@
 namespace saftbus
 {
 
+// A pool of MAX_CHUNCKS chuncks of CHUNCKSIZE bytes.
+// The free chuncks form a lock-free stack (linked through the next array),
+// so several threads can take and return chuncks at the same time.
 class ChunckAllocatorRT {
 	friend class Allocator;
 public:
-	ChunckAllocatorRT(size_t max_chuncks, size_t chuncksize);
+	// memory must have space for max_chuncks*chuncksize bytes, it is not owned by the ChunckAllocatorRT
+	ChunckAllocatorRT(size_t max_chuncks, size_t chuncksize, char *memory);
 	~ChunckAllocatorRT();
 	char* malloc(size_t size);
 	void free(char* ptr);
+	// take up to n chuncks with a single atomic operation, return the number of chuncks taken
+	size_t malloc_batch(char **ptrs, size_t n);
+	// return n chuncks with a single atomic operation
+	void free_batch(char **ptrs, size_t n);
 	void print_size();
 	void print_state();
 	bool contains(char *ptr);
 	bool full();
 	bool fits(size_t n);
 private:
+	static const uint32_t EMPTY = 0xffffffff;
 	const size_t MAX_CHUNCKS;
 	const size_t CHUNCKSIZE;
 	char   *chuncks;
-	size_t *backindices;
-	size_t *indices;
-	size_t allocated_chuncks;
+	std::atomic<uint32_t> *next; // next free chunck for each free chunck
+	std::atomic<uint64_t> head;  // lower 32 bits: first free chunck, upper 32 bits: tag that changes with every modification (prevents ABA)
+	std::atomic<size_t> free_chuncks;
+	std::atomic<size_t> high_water;     // maximum number of used chuncks so far
+	std::atomic<size_t> heap_fallbacks; // allocations that fit into this pool but went to the heap because this and all larger pools were exhausted
 };
 
+// Allocator with a number of pools for different chunck sizes. Allocations that don't fit
+// into any pool (or if all fitting pools are exhausted) are taken from the heap.
+//
+// All pools are carved out of one contiguous region. malloc finds the smallest fitting pool
+// in a size class table and free finds the pool of a pointer with a per-page table.
+//
+// Each thread has a small cache (magazine) of free chuncks for each pool. The magazines are
+// refilled from (and flushed back into) the shared pools in batches, so the hot path
+// doesn't touch any shared data. Chuncks that are cached in a magazine count as used.
 class Allocator {
 public:
+	static const size_t MAX_POOLS      = 16;
+	static const size_t MAGAZINE_SIZE  = 16;
+	static const size_t MAGAZINE_BATCH = 8;
+	static const size_t GRANULARITY    = 16;   // chunck sizes are rounded up to multiples of this
+	static const size_t POOL_ALIGNMENT = 4096; // pools start at multiples of this in the region
 	Allocator();
 	char* malloc(size_t n);
 	void free(char *ptr);
 	std::string fillstate();
+	// return all chuncks from the magazines of the calling thread. Called automatically when a thread exits.
+	void flush_thread_cache();
 private:
 	size_t num_allocators;
 	ChunckAllocatorRT **allocators;
-	size_t heap_allocations;
+	char    *region;
+	size_t   region_size;
+	uint8_t *pool_of_page;  // region offset / POOL_ALIGNMENT -> pool index
+	uint8_t *size_class;    // (size-1) / GRANULARITY -> index of smallest fitting pool
+	size_t   max_chuncksize;
+	std::atomic<size_t> heap_allocations;
+	std::atomic<size_t> heap_too_large; // allocations larger than any chunck
 };
 
 // Allocator *get_allocator();
@@ -56,4 +91,3 @@ private:
 
 }
 #endif
-
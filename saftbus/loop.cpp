@@ -28,16 +28,27 @@
 #include <cstring>
 #include <cassert>
 #include <sstream>
+#include <unordered_map>
+#include <deque>
+#include <cstdlib>
+#include <mutex>
+#include <atomic>
+#include <future>
 
 #include <poll.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace saftbus {
 
 
 	Source::Source() 
+		: loop(nullptr)
 	{
-		if (id_counter == -1) ++id_counter; // prevent id_counter to produce an id of 0 (no source should have id 0)
 		id = ++id_counter;
+		if (id == 0) id = ++id_counter; // no source should have id 0
 		id |= ((long)rand()%0xffffffff)<<32;
 	}
 	Source::~Source() {
@@ -57,8 +68,14 @@ namespace saftbus {
 	long Source::get_id() {
 		return id;
 	}
+	std::chrono::steady_clock::time_point Source::get_loop_time() const {
+		if (loop) {
+			return loop->get_time();
+		}
+		return std::chrono::steady_clock::now();
+	}
 
-	long Source::id_counter = 0;
+	std::atomic<long> Source::id_counter(0);
 
 	//////////////////////////////
 	//////////////////////////////
@@ -71,11 +88,74 @@ namespace saftbus {
 		int running_depth; 
 		long id;
 		static long id_counter;
+
+		Backend backend;
+
+		// TimeoutSources are not prepared/checked in every iteration. 
+		// They are kept in a min-heap, ordered by their next dispatch time.
+		struct Timer {
+			std::chrono::steady_clock::time_point dispatch_time;
+			long source_id;
+			static bool later(const Timer &lhs, const Timer &rhs) {
+				return lhs.dispatch_time > rhs.dispatch_time;
+			}
+		};
+		std::vector<Timer> timers;                                // entries of removed sources are skipped 
+		std::chrono::steady_clock::time_point now;                // clock is read once after waiting, sources use this value
+		std::unordered_map<long, size_t> source_index;            // source id -> position in sources
+		std::vector<Source*> generic_sources;                     // sources that are prepared and polled in every iteration
+
+		// A dispatched source may run a nested iteration, so every running_depth has its own set of vectors. 
+		// A deque, because references to the outer sets must stay valid when a deeper one is added.
+		struct Iteration {
+			std::vector<long> ready;                              // ids of sources that have to be checked/dispatched in this iteration
+			std::vector<struct pollfd> pfds;
+			std::vector<struct pollfd*> source_pfds;
+			bool wakeup;                                          // the wakeup_fd was readable
+		};
+		std::deque<Iteration> iterations;                         // iterations[running_depth-1] belongs to the current iteration
+
+		// only used by the epoll backend
+		int epoll_fd;
+		// both backends
+		int timer_fd;                                             // expires at the earliest timer (part of the epoll set with the epoll backend)
+		std::chrono::steady_clock::time_point timer_fd_expiration;
+		std::unordered_map<int, std::vector<IoSource*> > io_sources; // fd -> all IoSources that watch this fd
+		std::array<struct epoll_event, 64> events;
+
+		// functions from Loop::invoke, the wakeup_fd (an eventfd) interrupts the wait when they are added
+		int wakeup_fd;
+		std::mutex invoke_mutex;
+		std::vector<std::function<void()> > invoked;
+		void run_invoked();
+		void wakeup();
+
+		void add_timer(TimeoutSource *source);
+		void drop_stale_timers();
+		void arm_timer_fd();
+		void read_timer_fd();
+		void register_source(Source *source, size_t index);
+		void unregister_source(Source *source);
+		void update_epoll(int fd);
+		void release(std::unique_ptr<Source> &source);
+		void wait(Iteration &it, std::chrono::microseconds timeout);
 	};
 	long Loop::Impl::id_counter = 0;
 
-	
+	static Loop::Backend backend_from_env() {
+		const char *backend_env = getenv("SAFTBUS_LOOP_BACKEND");
+		if (backend_env != nullptr && std::string(backend_env) == "epoll") {
+			return Loop::Backend::Epoll;
+		}
+		return Loop::Backend::Poll;
+	}
+
 	Loop::Loop() 
+		: Loop(backend_from_env())
+	{
+	}
+
+	Loop::Loop(Backend backend) 
 		: d(new Impl)
 	{
 		// reserve all the vectors with enough space to avoid 
@@ -83,94 +163,353 @@ namespace saftbus {
 		const size_t revserve_that_much = 32;
 		d->added_sources.reserve(revserve_that_much);
 		d->sources.reserve(revserve_that_much);
+		d->generic_sources.reserve(revserve_that_much);
+		d->timers.reserve(revserve_that_much);
+		d->iterations.resize(1);
+		d->iterations[0].ready.reserve(revserve_that_much);
+		d->iterations[0].pfds.reserve(revserve_that_much);
+		d->iterations[0].source_pfds.reserve(revserve_that_much);
 		d->running = true;
 		d->running_depth = 0; // 0 means: the loop is not running
 		if (d->id_counter == -1) ++d->id_counter; // prevent d->id_counter to produce an id of 0 (no source should have id 0)
 		d->id = ++d->id_counter;
 		d->id |= ((long)rand()%0xffffffff)<<32;
+		d->now = std::chrono::steady_clock::now();
+		d->backend = backend;
+		d->epoll_fd = -1;
+		d->timer_fd = -1;
+		d->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		// steady_clock is CLOCK_MONOTONIC, so the timer_fd can be armed with dispatch times of TimeoutSources.
+		// Waiting for an absolute time needs no clock read before the wait.
+		d->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (d->backend == Backend::Epoll) {
+			d->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+			struct epoll_event ev = {};
+			ev.events = EPOLLIN;
+			ev.data.fd = d->timer_fd;
+			if (d->epoll_fd == -1 || d->timer_fd == -1 || epoll_ctl(d->epoll_fd, EPOLL_CTL_ADD, d->timer_fd, &ev) == -1) {
+				std::cerr << "cannot create epoll backend: " << strerror(errno) << ", falling back to poll" << std::endl;
+				if (d->epoll_fd != -1) close(d->epoll_fd);
+				d->epoll_fd = -1;
+				d->backend = Backend::Poll;
+			} else {
+				ev.data.fd = d->wakeup_fd;
+				epoll_ctl(d->epoll_fd, EPOLL_CTL_ADD, d->wakeup_fd, &ev);
+			}
+		}
 	}
 	Loop::~Loop() {
-		d->sources.clear();
-		d->added_sources.clear();
+		clear();
+		if (d->epoll_fd != -1) {
+			close(d->epoll_fd);
+		}
+		if (d->timer_fd != -1) {
+			close(d->timer_fd);
+		}
+		if (d->wakeup_fd != -1) {
+			close(d->wakeup_fd);
+		}
+	}
+
+	Loop::Backend Loop::get_backend() const {
+		return d->backend;
 	}
 
+	std::chrono::steady_clock::time_point Loop::get_time() const {
+		return d->now;
+	}
+
+	static thread_local Loop *thread_default_loop = nullptr;
+
 	Loop& Loop::get_default() {
+		if (thread_default_loop) {
+			return *thread_default_loop;
+		}
 		static Loop default_loop;
 		return default_loop;
 	}
 
+	void Loop::set_thread_default(Loop *loop) {
+		thread_default_loop = loop;
+	}
+
+	void Loop::Impl::add_timer(TimeoutSource *source) {
+		timers.push_back(Timer{source->dispatch_time, source->get_id()});
+		std::push_heap(timers.begin(), timers.end(), Timer::later);
+	}
+
+	// remove entries of sources that are gone, otherwise they would cause useless wakeups
+	void Loop::Impl::drop_stale_timers() {
+		while (!timers.empty() && source_index.find(timers.front().source_id) == source_index.end()) {
+			std::pop_heap(timers.begin(), timers.end(), Timer::later);
+			timers.pop_back();
+		}
+	}
+
+	void Loop::Impl::arm_timer_fd() {
+		auto expiration = timers.empty() ? std::chrono::steady_clock::time_point() : timers.front().dispatch_time;
+		if (expiration == timer_fd_expiration) {
+			return; // already armed for this time
+		}
+		struct itimerspec spec = {};
+		if (!timers.empty()) {
+			auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(expiration.time_since_epoch()).count();
+			spec.it_value.tv_sec  = ns / 1000000000;
+			spec.it_value.tv_nsec = ns % 1000000000;
+			if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) {
+				spec.it_value.tv_nsec = 1; // all zero would disarm the timer 
+			}
+		} // else: all zero disarms the timer
+		timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr);
+		timer_fd_expiration = expiration;
+	}
+
+	void Loop::Impl::read_timer_fd() {
+		uint64_t expirations;
+		if (read(timer_fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+			// nothing to do, the expired timers are found in the timer heap
+		}
+		timer_fd_expiration = std::chrono::steady_clock::time_point(); // expired, arm it again even for the same time
+	}
+
+	// make the source known to the loop. index is the position of the source in the sources vector
+	void Loop::Impl::register_source(Source *source, size_t index) {
+		source_index[source->get_id()] = index;
+		IoSource *io_source = dynamic_cast<IoSource*>(source);
+		if (io_source && backend == Backend::Epoll) {
+			io_sources[io_source->pfd.fd].push_back(io_source);
+			update_epoll(io_source->pfd.fd);
+		} else if (TimeoutSource *timeout_source = dynamic_cast<TimeoutSource*>(source)) {
+			add_timer(timeout_source);
+		} else {
+			generic_sources.push_back(source);
+		}
+	}
+
+	void Loop::Impl::unregister_source(Source *source) {
+		source_index.erase(source->get_id());
+		IoSource *io_source = dynamic_cast<IoSource*>(source);
+		if (io_source && backend == Backend::Epoll) {
+			auto &fd_sources = io_sources[io_source->pfd.fd];
+			fd_sources.erase(std::remove(fd_sources.begin(), fd_sources.end(), io_source), fd_sources.end());
+			update_epoll(io_source->pfd.fd);
+		} else if (dynamic_cast<TimeoutSource*>(source)) {
+			// the timer heap entry is skipped when it expires
+		} else {
+			generic_sources.erase(std::remove(generic_sources.begin(), generic_sources.end(), source), generic_sources.end());
+		}
+	}
+
+	// Several IoSources may watch the same fd (e.g. one for POLLIN and one for POLLOUT), 
+	// but an fd can be in the epoll set only once. Register the union of all their conditions.
+	void Loop::Impl::update_epoll(int fd) {
+		auto fd_sources = io_sources.find(fd);
+		if (fd_sources == io_sources.end()) {
+			return;
+		}
+		if (fd_sources->second.empty()) {
+			io_sources.erase(fd_sources);
+			// fails with EBADF if the fd was already closed by the source, which removed it from the epoll set anyway
+			epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+			return;
+		}
+		struct epoll_event ev = {};
+		ev.data.fd = fd;
+		for (auto &io_source: fd_sources->second) {
+			ev.events |= io_source->pfd.events;
+		}
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) == -1 && errno == ENOENT) {
+			if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+				std::cerr << "cannot add fd " << fd << " to epoll set: " << strerror(errno) << std::endl;
+			}
+		}
+	}
+
+	// remove a source from the loop, works also during an iteration
+	void Loop::Impl::release(std::unique_ptr<Source> &source) {
+		if (source) {
+			unregister_source(source.get());
+		}
+		source.reset();
+	}
+
+	static struct timespec to_timespec(std::chrono::microseconds timeout) {
+		struct timespec ts;
+		ts.tv_sec  = timeout.count() / 1000000;
+		ts.tv_nsec = (timeout.count() % 1000000) * 1000;
+		return ts;
+	}
+
+	// Wait until any of the fds in it.pfds is ready or until the timeout expired.
+	// A negative timeout means: no timeout. 
+	// With the epoll backend, pfds[0] is the epoll fd and timers are handled by the timer_fd in the epoll set.
+	void Loop::Impl::wait(Iteration &it, std::chrono::microseconds timeout) {
+		auto &pfds        = it.pfds;
+		auto &source_pfds = it.source_pfds;
+		struct timespec ts = to_timespec(timeout);
+		struct timespec *timeout_ts = (timeout.count() < 0) ? nullptr : &ts;
+		int epoll_result = 0;
+		if (backend == Backend::Poll) {
+			if (pfds.size() > 0) {
+				if (ppoll(&pfds[0], pfds.size(), timeout_ts, nullptr) > 0) {
+					// copy the results back to the owners of the pfds
+					for (unsigned i = 0; i < pfds.size(); ++i) {
+						if (source_pfds[i]) {
+							source_pfds[i]->revents = pfds[i].revents;
+						} else if (pfds[i].revents & POLLIN) {
+							// the wakeup_fd and the timer_fd have no owner
+							if (pfds[i].fd == wakeup_fd) {
+								it.wakeup = true;
+							} else {
+								read_timer_fd();
+							}
+						}
+					}
+				}
+			} else if (timeout.count() > 0) {
+				std::this_thread::sleep_for(timeout);
+			}
+			return;
+		}
+		if (pfds.size() > 1) {
+			// generic sources have their own fds, poll them together with the epoll fd
+			if (ppoll(&pfds[0], pfds.size(), timeout_ts, nullptr) > 0) {
+				for (unsigned i = 1; i < pfds.size(); ++i) {
+					source_pfds[i]->revents = pfds[i].revents;
+				}
+				if (pfds[0].revents & POLLIN) {
+					epoll_result = epoll_wait(epoll_fd, &events[0], events.size(), 0);
+				}
+			}
+		} else if (!io_sources.empty() || !timers.empty() || !sources.empty() || timeout.count() > 0) {
+			// timeouts from generic sources have millisecond resolution anyway, round up.
+			int timeout_ms = (timeout.count() < 0) ? -1 : (timeout.count()+999)/1000;
+			epoll_result = epoll_wait(epoll_fd, &events[0], events.size(), timeout_ms);
+		}
+		for (int i = 0; i < epoll_result; ++i) {
+			if (events[i].data.fd == wakeup_fd) {
+				it.wakeup = true; // the eventfd is read in run_invoked
+				continue;
+			}
+			if (events[i].data.fd == timer_fd) {
+				read_timer_fd();
+				continue;
+			}
+			auto fd_sources = io_sources.find(events[i].data.fd);
+			if (fd_sources == io_sources.end()) {
+				continue;
+			}
+			for (auto &io_source: fd_sources->second) {
+				io_source->pfd.revents = events[i].events;
+				it.ready.push_back(io_source->get_id());
+			}
+		}
+	}
+
 	bool Loop::iteration(bool may_block) {
 		++d->running_depth;
-		static const auto no_timeout = std::chrono::milliseconds(-1);
-		std::vector<struct pollfd> pfds;
-		std::vector<struct pollfd*> source_pfds;
+		if (d->iterations.size() < (size_t)d->running_depth) {
+			d->iterations.resize(d->running_depth);
+		}
+		Impl::Iteration &it = d->iterations[d->running_depth-1];
+		static const auto no_timeout = std::chrono::microseconds(-1);
 		auto timeout = no_timeout; 
 
-		// unsigned us = 0;
-		auto start = std::chrono::steady_clock::now();
-		auto stop = std::chrono::steady_clock::now();
-
 		//////////////////
 		// preparation 
 		// (find the earliest timeout)
 		//////////////////
-		for(auto &source: d->sources) {
-			if (!source) continue; 
-
-			auto timeout_from_source = no_timeout;
+		it.pfds.clear();
+		it.source_pfds.clear();
+		it.ready.clear();
+		it.wakeup = false;
+		if (d->backend == Backend::Epoll) {
+			it.pfds.push_back(pollfd{d->epoll_fd, POLLIN, 0}); // all IoSources and the timer_fd are represented by the epoll fd
+			it.source_pfds.push_back(nullptr);
+		}
+		for (auto &source: d->generic_sources) {
+			auto timeout_from_source = std::chrono::milliseconds(-1);
 			source->prepare(timeout_from_source); // source may leave timeout_from_source unchanged 
-			if (timeout_from_source != no_timeout) {
+			if (timeout_from_source.count() >= 0) {
 				if (timeout == no_timeout) {
 					timeout = timeout_from_source;
 				} else {
-					timeout = std::min(timeout, timeout_from_source);
+					timeout = std::min<std::chrono::microseconds>(timeout, timeout_from_source);
 				}
 			}
-			for(auto it = source->pfds.cbegin(); it != source->pfds.cbegin()+source->pfds.size(); ++it) {
+			for (auto &pfd: source->pfds) {
 				// create a packed array of pfds that can be passed to poll()
-				pfds.push_back(**it);
+				it.pfds.push_back(*pfd);
 				// also create an array of pointers to pfds to where the poll() results can be copied back
-				source_pfds.push_back(*it);
+				it.source_pfds.push_back(pfd);
 			}
 		}
+		if (d->backend == Backend::Poll && d->wakeup_fd != -1 && (!d->sources.empty() || !d->added_sources.empty())) {
+			// an empty loop doesn't wait for Loop::invoke, just like it doesn't wait for anything else
+			it.pfds.push_back(pollfd{d->wakeup_fd, POLLIN, 0});
+			it.source_pfds.push_back(nullptr);
+		}
+		d->drop_stale_timers();
 		if (!may_block) { 
-			timeout = std::chrono::milliseconds(0);
+			timeout = std::chrono::microseconds(0);
+		} else if (d->backend == Backend::Epoll) {
+			d->arm_timer_fd(); 
+		} else if (!d->timers.empty() && d->timers.front().dispatch_time <= d->now) {
+			timeout = std::chrono::microseconds(0); // a timer is already due
+		} else if (!d->timers.empty() && d->timer_fd != -1) {
+			// ppoll waits for the timer_fd, which expires at the absolute dispatch time of the earliest timer
+			d->arm_timer_fd();
+			it.pfds.push_back(pollfd{d->timer_fd, POLLIN, 0});
+			it.source_pfds.push_back(nullptr);
+		} else if (!d->timers.empty()) {
+			// Without timer_fd, the relative timeout for ppoll needs the current time. d->now is from before 
+			// the dispatching of the previous iteration, using it would delay the timer by the duration 
+			// of that dispatching. 
+			auto timeout_from_timer = std::chrono::duration_cast<std::chrono::microseconds>(d->timers.front().dispatch_time - std::chrono::steady_clock::now());
+			if (timeout_from_timer < std::chrono::microseconds(0)) {
+				timeout_from_timer = std::chrono::microseconds(0);
+			}
+			if (timeout == no_timeout || timeout_from_timer < timeout) {
+				timeout = timeout_from_timer;
+			}
 		}
+
 		//////////////////
 		// polling / waiting
 		//////////////////
-		if (pfds.size() > 0) {
-			// std::cerr << "polling timeout_ms = " << timeout.count() << std::endl;
-			int poll_result = 0;
-			if ((poll_result = poll(&pfds[0], pfds.size(), timeout.count())) > 0) {
-				// copy the results back to the owners of the pfds
-				for (unsigned i = 0; i < pfds.size();++i) {
-					source_pfds[i]->revents = pfds[i].revents;
-				}
-			} else if (poll_result < 0) {
-				// std::cerr << "poll error: " << strerror(errno) << std::endl;
-			} else {
-				// std::cerr << "poll result = " << poll_result << std::endl;
-			}
-			start = std::chrono::steady_clock::now();
-
-		} else if (timeout > std::chrono::milliseconds(0)) {
-			std::this_thread::sleep_for(timeout);
-			start = std::chrono::steady_clock::now();
-			
-		}
+		d->wait(it, timeout);
+		d->now = std::chrono::steady_clock::now();
 
 		//////////////////
 		// dispatching
 		//////////////////
-		for (auto &source: d->sources) {
-			if (!source) continue;
-
+		if (it.wakeup) {
+			d->run_invoked();
+		}
+		while (!d->timers.empty() && d->timers.front().dispatch_time <= d->now) {
+			it.ready.push_back(d->timers.front().source_id);
+			std::pop_heap(d->timers.begin(), d->timers.end(), Impl::Timer::later);
+			d->timers.pop_back();
+		}
+		for (auto &source: d->generic_sources) {
+			it.ready.push_back(source->get_id());
+		}
+		for (auto &source_id: it.ready) {
+			auto index = d->source_index.find(source_id);
+			if (index == d->source_index.end()) {
+				continue; // source was removed in the meantime
+			}
+			auto &source = d->sources[index->second];
+			TimeoutSource *timeout_source = dynamic_cast<TimeoutSource*>(source.get());
 			if (source->check()) { // if check returns true, dispatch is called
 				if (!source->dispatch()) { // if dispatch returns false, the source is removed
-					source.reset();
+					d->release(source);
+					continue;
 				}
 			}
+			if (timeout_source && d->source_index.count(source_id)) {
+				d->add_timer(timeout_source); // schedule the next dispatch
+			}
 		}
 
 		//////////////////////////////////////////////////////
@@ -180,13 +519,21 @@ namespace saftbus {
 		//////////////////////////////////////////////////////
 		if (d->running_depth == 1) {
 			// std::cerr << "cleaning up sources" << d->sources.size() << std::endl;
+			size_t size_before = d->sources.size();
 			d->sources.erase(std::remove_if(d->sources.begin(), d->sources.end(), [](std::unique_ptr<Source> &s){return !s;}), 
 				          d->sources.end());
+			if (d->sources.size() != size_before) {
+				// positions of the remaining sources have changed
+				for (size_t i = 0; i < d->sources.size(); ++i) {
+					d->source_index[d->sources[i]->get_id()] = i;
+				}
+			}
 
 			// adding new sources
 			for (auto &added_source: d->added_sources) {
 				if (added_source) {
 					d->sources.push_back(std::move(added_source));
+					d->register_source(d->sources.back().get(), d->sources.size()-1);
 				}
 			}
 			d->added_sources.clear();
@@ -194,8 +541,6 @@ namespace saftbus {
 
 		--d->running_depth;
 
-		stop = std::chrono::steady_clock::now();
-
 		return !d->sources.empty();
 	}
 
@@ -232,6 +577,7 @@ namespace saftbus {
 			d->added_sources.push_back(std::move(source));
 		} else {
 			d->sources.push_back(std::move(source));
+			d->register_source(d->sources.back().get(), d->sources.size()-1);
 		}
 		return result;
 	}
@@ -246,7 +592,7 @@ namespace saftbus {
 		if (s.loop_id == d->id) { // make sure s was connected to this loop
 			auto source = d->sources.begin();
 			if ((source=std::find(source, d->sources.end(), s)) != d->sources.end()) {
-				source->reset();
+				d->release(*source);
 			}
 			source = d->added_sources.begin();
 			if ((source=std::find(source, d->added_sources.end(), s)) != d->added_sources.end()) {
@@ -255,9 +601,81 @@ namespace saftbus {
 		}
 	}
 
+	// Called whenever the wakeup_fd was readable. The eventfd is drained before the functions are taken, 
+	// so a function that is added after that point always leaves the eventfd readable for the next iteration.
+	void Loop::Impl::run_invoked() {
+		uint64_t count;
+		if (read(wakeup_fd, &count, sizeof(count)) != sizeof(count)) {
+			// nothing to do, the eventfd was already drained (e.g. by a nested iteration)
+		}
+		std::vector<std::function<void()> > slots; // local, because a slot may run a nested iteration
+		{
+			std::lock_guard<std::mutex> lock(invoke_mutex);
+			slots.swap(invoked);
+		}
+		for (auto &slot: slots) {
+			try {
+				slot();
+			} catch (std::exception &e) {
+				std::cerr << "Exception in function called by Loop::invoke: " << e.what() << std::endl;
+			}
+		}
+	}
+
+	void Loop::invoke(std::function<void()> slot) {
+		{
+			std::lock_guard<std::mutex> lock(d->invoke_mutex);
+			d->invoked.push_back(std::move(slot));
+		}
+		d->wakeup();
+	}
+
+	void Loop::Impl::wakeup() {
+		uint64_t one = 1;
+		if (write(wakeup_fd, &one, sizeof(one)) != sizeof(one)) {
+			// the eventfd counter is already at its maximum, the loop wakes up anyway
+		}
+	}
+
+	void Loop::invoke_and_wait(std::function<void()> slot) {
+		// Only a loop that was explicitly set as default belongs to this thread.
+		// The global default loop may run in any other thread.
+		Loop *caller = thread_default_loop;
+		if (caller == this) {
+			slot();
+			return;
+		}
+		std::promise<void> done;
+		std::future<void> result = done.get_future();
+		invoke([&slot, &done, caller]() {
+			try {
+				slot();
+				done.set_value();
+			} catch (...) {
+				done.set_exception(std::current_exception());
+			}
+			if (caller) {
+				caller->d->wakeup(); // done and slot may be gone already, caller is still there
+			}
+		});
+		// The other thread may call invoke_and_wait on the loop of this thread while slot runs. 
+		// Execute these functions here, otherwise both threads would wait forever.
+		while (caller && result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			struct pollfd pfd = {caller->d->wakeup_fd, POLLIN, 0};
+			if (poll(&pfd, 1, -1) > 0) {
+				caller->d->run_invoked();
+			}
+		}
+		result.get();
+	}
+
 	void Loop::clear() {
+		for (auto &source: d->sources) {
+			d->release(source);
+		}
 		d->sources.clear();
 		d->added_sources.clear();
+		d->timers.clear();
 	}
 
 
@@ -266,28 +684,31 @@ namespace saftbus {
 	//////////////////////////////
 
 
-	TimeoutSource::TimeoutSource(std::function<bool(void)> s, std::chrono::milliseconds i, std::chrono::milliseconds o) 
-		: slot(s), interval(i), dispatch_time(std::chrono::steady_clock::now()+o)
-	{
-		if (interval <= std::chrono::milliseconds(0)) {
-			interval = std::chrono::milliseconds(1);
+	static std::chrono::microseconds at_least_1ms_if_zero(std::chrono::microseconds interval) {
+		// A zero interval was always clamped to 1 ms. Keep that for existing users, 
+		// but allow any positive interval below 1 ms.
+		if (interval <= std::chrono::microseconds(0)) {
+			return std::chrono::milliseconds(1);
 		}
+		return interval;
 	}
-	TimeoutSource::TimeoutSource(std::function<bool(void)> s, std::chrono::milliseconds i) 
-		: slot(s), interval(i), dispatch_time(std::chrono::steady_clock::now()+i)
+
+	TimeoutSource::TimeoutSource(std::function<bool(void)> s, std::chrono::microseconds i, std::chrono::microseconds o) 
+		: slot(s), interval(at_least_1ms_if_zero(i)), dispatch_time(std::chrono::steady_clock::now()+o)
+	{
+	}
+	TimeoutSource::TimeoutSource(std::function<bool(void)> s, std::chrono::microseconds i) 
+		: slot(s), interval(at_least_1ms_if_zero(i)), dispatch_time(std::chrono::steady_clock::now()+i)
 	{
-		if (interval <= std::chrono::milliseconds(0)) {
-			interval = std::chrono::milliseconds(1);
-		}
 	}
 
 	TimeoutSource::~TimeoutSource() {
 	}
 
-	// prepare is called by Loop to find out the next dispatch_time of all sources
-	// and it will wait for min() of all reported dispatch_times.
+	// A TimeoutSource is not prepared by the Loop, the Loop keeps it in a timer heap.
+	// This is only here for completeness.
 	bool TimeoutSource::prepare(std::chrono::milliseconds &timeout_ms) {
-		auto now = std::chrono::steady_clock::now();
+		auto now = get_loop_time();
 		timeout_ms = std::chrono::duration_cast<std::chrono::milliseconds>(dispatch_time - now); 
 		if (timeout_ms.count() <= 0) {
 			timeout_ms = std::chrono::milliseconds(0);
@@ -296,20 +717,15 @@ namespace saftbus {
 		return false;
 	}
 
-	// After the wait phase, the loop will call check on all source.
-	// Loop will call dispatch on all sources where check returns true. 
+	// Loop calls check after the dispatch time was reached.
+	// Loop will call dispatch if check returns true. 
 	bool TimeoutSource::check() {
-		auto now = std::chrono::steady_clock::now();
-		auto timeout_ms = std::chrono::duration_cast<std::chrono::milliseconds>(dispatch_time - now); 
-		if (timeout_ms.count() <= 0) {
-			return true;
-		}
-		return false;
+		return dispatch_time <= get_loop_time();
 	}
 
 	// Execute whatever action is attached to the source
 	bool TimeoutSource::dispatch() {
-		auto now = std::chrono::steady_clock::now();
+		auto now = get_loop_time();
 		do {
 			dispatch_time += interval;
 		} while (now >= dispatch_time);
@@ -27,6 +27,7 @@
 #include <functional>
 #include <vector>
 #include <set>
+#include <atomic>
 
 #include <poll.h>
 
@@ -49,10 +50,12 @@ namespace saftbus {
 		void add_poll(pollfd *pfd);
 		void remove_poll(pollfd *pfd);
 		void clear_poll();
+		/// @brief the time at which the loop woke up in the current iteration. Use this instead of reading the clock.
+		std::chrono::steady_clock::time_point get_loop_time() const;
 	private:
 		Loop *loop;
 		std::vector<pollfd*> pfds;
-		static long id_counter;
+		static std::atomic<long> id_counter; // Sources may be created in the threads of different Loops
 		long id; 
 	};
 	/// @brief unique identifier for an event source in a saftbus::Loop
@@ -75,11 +78,30 @@ namespace saftbus {
 	///   * in case there are any file descriptors, do the poll system call
 	///   * in case there are no file descriptors, wait until the earliest timeout
 	///   * call Source::dispatch for all sources where Source::check returns true.
+	///
+	/// TimeoutSources are not prepared in every iteration. They are kept in a timer heap and only 
+	/// the ones that expired are checked and dispatched. The clock is read once after the wait, 
+	/// Sources can obtain this time with Source::get_loop_time() (or Loop::get_time()).
+	///
+	/// With the Epoll backend, IoSources are registered once in an epoll set and the timer heap 
+	/// drives a timerfd in the same set. Only sources that are ready are checked and dispatched.
+	/// All other Source types are still prepared and polled in every iteration.
 	class Loop {
 		struct Impl; std::unique_ptr<Impl> d;
 	public:
+		/// @brief the mechanism that is used to wait for events
+		enum class Backend {
+			Poll,  ///< collect the file descriptors of all sources and call poll() in every iteration
+			Epoll, ///< IoSources stay registered in an epoll set, timers are delivered by a timerfd
+		};
+		/// @brief create a Loop with the backend given in the environment variable SAFTBUS_LOOP_BACKEND ("poll" or "epoll").
+		/// Poll is used if the variable is not set.
 		Loop();
+		Loop(Backend backend);
 		~Loop();
+		Backend get_backend() const;
+		/// @brief the time at which the loop woke up in the current (or last) iteration.
+		std::chrono::steady_clock::time_point get_time() const;
 		bool iteration(bool may_block);
 		void run();
 		bool quit();
@@ -92,7 +114,27 @@ namespace saftbus {
 		}
 		void remove(SourceHandle s);
 		void clear(); // remove all sources
+
+		/// @brief call slot in the next iteration of this loop. This function can be called from any thread.
+		///
+		/// This is how work is handed over to a Loop that runs in another thread. The loop wakes up 
+		/// even if it waits for events. The loop needs at least one Source, otherwise run() returns.
+		void invoke(std::function<void()> slot);
+		/// @brief call slot in the thread of this loop and wait until it returned. Exceptions thrown by slot are rethrown.
+		///
+		/// If this loop was set as the default loop of the calling thread (see set_thread_default), slot is called directly.
+		/// While waiting, a thread with such a loop executes the functions that other threads invoke 
+		/// in it. Two of these threads can wait for each other's loops without deadlock.
+		/// Other threads just block until slot returned.
+		void invoke_and_wait(std::function<void()> slot);
+
+		/// @brief the default loop of the calling thread (see set_thread_default) or the global default loop.
 		static Loop &get_default();
+		/// @brief make loop the result of get_default() in the calling thread. 
+		///
+		/// Code that connects its sources to Loop::get_default() uses this loop if it runs in this thread.
+		/// nullptr makes the global default loop the default of this thread again.
+		static void set_thread_default(Loop *loop);
 	};
 
     /////////////////////////////////////
@@ -102,15 +144,17 @@ namespace saftbus {
 	/// @brief An event source that is active after a given amount of time has passed
 	/// 
 	/// The source is removed whenever the connected function returns false.
+	/// Intervals have microsecond resolution (std::chrono::milliseconds converts implicitly).
 	class TimeoutSource : public Source {
+		friend class Loop;
 	public:
 		/// @param slot the function that is called periodically. 
-		/// @param interval duration between calls to slot. If interval is smaller than 1 ms, it is set to 1 ms.
+		/// @param interval duration between calls to slot. If interval is zero or negative, it is set to 1 ms.
 		/// @param offset   fist execution starts after waiting for offset amount of time.
-		TimeoutSource(std::function<bool(void)> slot, std::chrono::milliseconds interval, std::chrono::milliseconds offset);
-		/// @param slot the function that is called periodically. If interval is smaller than 1 ms, it is set to 1 ms.
+		TimeoutSource(std::function<bool(void)> slot, std::chrono::microseconds interval, std::chrono::microseconds offset);
+		/// @param slot the function that is called periodically. If interval is zero or negative, it is set to 1 ms.
 		/// @param interval duration between calls to slot, fist execution starts at after waiting one interval worth of time.
-		TimeoutSource(std::function<bool(void)> slot, std::chrono::milliseconds interval);
+		TimeoutSource(std::function<bool(void)> slot, std::chrono::microseconds interval);
 		~TimeoutSource();
 		bool prepare(std::chrono::milliseconds &timeout_ms) override;
 		bool check() override;
@@ -118,7 +162,7 @@ namespace saftbus {
 		std::string type() override;
 	private:
 		std::function<bool(void)> slot;
-		std::chrono::milliseconds interval;
+		std::chrono::microseconds interval;
 		std::chrono::time_point<std::chrono::steady_clock> dispatch_time;		
 	};
 
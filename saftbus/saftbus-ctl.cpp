@@ -96,7 +96,13 @@ void print_status(saftbus::SaftbusInfo &saftbus_info) {
 	std::cout << std::endl;
 	std::cout << "connected client processes:" << std::endl;
 	for (auto &client: saftbus_info.client_infos) {
-		std::cout << "  " << client.client_fd << " (pid=" << client.process_id << ")" << std::endl;
+		std::cout << "  " << client.client_fd << " (pid=" << client.process_id << ")";
+		for (auto &dropped: client.dropped_signals) {
+			if (dropped.second > 0) {
+				std::cout << " signal fd " << dropped.first << " dropped " << dropped.second;
+			}
+		}
+		std::cout << std::endl;
 	}
 
 	for (auto &additional: saftbus_info.additional_info) {
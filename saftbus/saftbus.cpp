@@ -22,9 +22,11 @@
 
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -87,50 +89,82 @@ namespace saftbus {
 	}
 	bool Serializer::write_to_no_init(int fd) {
 		int size = _data.size();
-		int result;
-		result = write_all(fd, (char*)&size, sizeof(size));
-		if (result < (int)sizeof(size)) {
-			//std::cerr << "write_all returned " << result << ". Expected result " << sizeof(size) << ". errno: " << strerror(errno) << std::endl;
+		// The length and the first chunk of data go out in one message.
+		// Sockets are of type SOCK_SEQPACKET, so writev either sends everything or nothing.
+		int first_chunk = std::min(size, Deserializer::first_chunk_size);
+		struct iovec iov[2];
+		iov[0].iov_base = &size;
+		iov[0].iov_len  = sizeof(size);
+		iov[1].iov_base = &_data[0];
+		iov[1].iov_len  = first_chunk;
+		int result = ::writev(fd, iov, 2);
+		if (result < (int)sizeof(size)+first_chunk) {
+			//std::cerr << "writev returned " << result << ". Expected result " << sizeof(size)+first_chunk << ". errno: " << strerror(errno) << std::endl;
 			return false;
 		}
-		// std::cerr << "write_to " << fd << " so many bytes " << size << std::endl;
-		result = write_all(fd, (char*)&_data[0], size);
-		if (result < size) {
-			//std::cerr << "write_all returned " << result << ". Expected result " << size << ". errno: " << strerror(errno) << std::endl;
-			return false;
+		// large buffers need additional messages
+		if (size > first_chunk) {
+			result = write_all(fd, (char*)&_data[first_chunk], size-first_chunk);
+			if (result < size-first_chunk) {
+				//std::cerr << "write_all returned " << result << ". Expected result " << size-first_chunk << ". errno: " << strerror(errno) << std::endl;
+				return false;
+			}
 		}
-		// std::cerr << "wrote " << size << " bytes to fd " << fd << std::endl;
-		// put_init();
 		return true;
 	}
 	bool Serializer::empty()
 	{
 		return _data.empty();
 	}
+	const std::vector<char>& Serializer::get_data() const
+	{
+		return _data;
+	}
 	void Serializer::put_init()
 	{
 		_data.clear();
 	}
+	void Serializer::swap(Serializer &other)
+	{
+		_data.swap(other._data);
+		std::swap(_iter, other._iter);
+	}
 
 	bool Deserializer::read_from(int fd) {
 		int size;
-		int result;
-		result = read_all(fd, (char*)&size, sizeof(size));
+		// The buffer is reused between calls. Resizing it doesn't zero-fill (see DefaultInitAllocator),
+		// so readv writes directly into memory that was allocated by a previous call.
+		_data.resize(first_chunk_size);
+		struct iovec iov[2];
+		iov[0].iov_base = &size;
+		iov[0].iov_len  = sizeof(size);
+		iov[1].iov_base = &_data[0];
+		iov[1].iov_len  = first_chunk_size;
+		int result = ::readv(fd, iov, 2);
 		// std::cerr << "read_from " << fd << " so many bytes: " << size << std::endl;
 		if (result < (int)sizeof(size)) {
-			//std::cerr << "read_all returned " << result << ". Expected result " << sizeof(size) << ". errno: " << strerror(errno) << std::endl;
+			//std::cerr << "readv returned " << result << ". Expected result >= " << sizeof(size) << ". errno: " << strerror(errno) << std::endl;
 			return false;
 		}
+		int received = result - sizeof(size);
 		_data.resize(size);
-		result = read_all(fd, (char*)&_data[0], size);
-		if (result < size) {
-			//std::cerr << "read_all returned " << result << ". Expected result " << size << ". errno: " << strerror(errno) << std::endl;
-			return false;
+		if (received < size) {
+			// the rest of a large buffer follows in additional messages
+			result = read_all(fd, (char*)&_data[received], size-received);
+			if (result < size-received) {
+				//std::cerr << "read_all returned " << result << ". Expected result " << size-received << ". errno: " << strerror(errno) << std::endl;
+				return false;
+			}
 		}
 		get_init();
 		// std::cerr << "read " << size << " bytes from fd " << fd << std::endl;
 		return true;
 	}
+	void Deserializer::read_from_buffer(const char *buffer, int size) {
+		_data.resize(size);
+		memcpy(&_data[0], buffer, size);
+		get_init();
+	}
 	void Deserializer::save() const
 	{
 		_saved_iter = _iter;
@@ -139,6 +173,13 @@ namespace saftbus {
 	{
 		_iter = _saved_iter;
 	}
+	// std::vector::swap keeps the iterators valid, they point into the other object afterwards
+	void Deserializer::swap(Deserializer &other)
+	{
+		_data.swap(other._data);
+		std::swap(_iter, other._iter);
+		std::swap(_saved_iter, other._saved_iter);
+	}
 	// has to be called before any call to get()
 	void Deserializer::get_init() const
 	{
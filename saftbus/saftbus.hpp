@@ -26,6 +26,8 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <memory>
+#include <type_traits>
 
 /// @brief classes and functions of the saftbus interprocess communication library.
 /// 
@@ -65,6 +67,21 @@ namespace saftbus {
 		EXCEPTION,
 	};
 
+	/// @brief Object id 0 is never assigned to a Service. A request that starts with it is a tagged request:
+	/// a request id (uint32_t) follows, then the usual request (object id, interface_no, function_no, arguments).
+	/// The reply starts with the same request id.
+	const unsigned async_call_object_id = 0;
+
+	/// @brief Object id 0xffffffff is never assigned to a Service either. A request that starts with it is a batch:
+	/// the number of calls (uint32_t) follows, then every call as std::vector<char> that contains a complete request
+	/// (object id, interface_no, function_no, arguments). The reply contains the number of results and one
+	/// std::vector<char> with the complete reply for each call, in the same order.
+	const unsigned batch_call_object_id = 0xffffffff;
+
+	/// @brief The exception message that is sent when a request addresses an object id that doesn't exist (anymore).
+	/// Proxies use it to drop the object id from their object path cache.
+	const char * const object_not_found_message = "remote call failed because service object was not found";
+
 	int write_all(int fd, const char *buffer, int size);
 	int read_all(int fd, char *buffer, int size);
 
@@ -86,6 +103,29 @@ namespace saftbus {
 	class Serializer;
 	class Deserializer;
 
+	/// @brief Allocator adaptor that default-initializes elements instead of value-initializing them.
+	///
+	/// A std::vector<char> with this allocator does not zero-fill memory on resize. This is used by 
+	/// the Deserializer to grow its receive buffer without touching bytes that are overwritten by the
+	/// next read anyway.
+	template<typename T, typename A = std::allocator<T> >
+	class DefaultInitAllocator : public A {
+		typedef std::allocator_traits<A> a_t;
+	public:
+		template<typename U> struct rebind {
+			typedef DefaultInitAllocator<U, typename a_t::template rebind_alloc<U> > other;
+		};
+		using A::A;
+		template<typename U> 
+		void construct(U* ptr) noexcept(std::is_nothrow_default_constructible<U>::value) {
+			::new(static_cast<void*>(ptr)) U;
+		}
+		template<typename U, typename... Args> 
+		void construct(U* ptr, Args&&... args) {
+			a_t::construct(static_cast<A&>(*this), ptr, std::forward<Args>(args)...);
+		}
+	};
+
 	/// @brief custom types can be sent over saftbus if they derive from 
 	/// this class and implement serialize and deserializ methods
 	struct SerDesAble {
@@ -112,6 +152,9 @@ namespace saftbus {
 	///  * ...
 	class Serializer
 	{
+		friend class SignalRing;
+		friend class SignalQueue;
+		friend class Service;
 	public:
 		Serializer(int reserve = 4096)
 		{
@@ -119,7 +162,9 @@ namespace saftbus {
 			_iter = _data.begin();
 		}
 
-		// write the length of the serdes data buffer and the buffer content to file descriptor fd
+		// write the length of the serdes data buffer and the buffer content to file descriptor fd.
+		// The length and the first part of the buffer are sent in one message (a single writev call),
+		// only buffers larger than Deserializer::first_chunk_size need additional write calls.
 		bool write_to(int fd);
 		bool write_to_no_init(int fd);
 
@@ -204,8 +249,14 @@ namespace saftbus {
 
 		bool empty();
 
+		// the serialized data, e.g. to embed it as one element into another Serializer
+		const std::vector<char>& get_data() const;
+
 		// has to be called before first call to put()
 		void put_init();
+
+		// exchange the data with other, e.g. to hand a reply over to another thread without copying
+		void swap(Serializer &other);
 	private:
 
 
@@ -218,6 +269,7 @@ namespace saftbus {
 	///
 	class Deserializer
 	{
+		friend class SignalRing;
 	public:
 		Deserializer(int reserve = 4096)
 		{
@@ -225,9 +277,17 @@ namespace saftbus {
 			_iter = _data.begin();
 		}
 
-		// fill the serdes data buffer by reading data from the file descriptor fd
+		// fill the serdes data buffer by reading data from the file descriptor fd.
+		// The length and up to first_chunk_size bytes of payload are received with a single readv call
+		// directly into the (reused) data buffer.
 		bool read_from(int fd);
 
+		// fill the serdes data buffer with size bytes from buffer (e.g. a message that was received in a batch)
+		void read_from_buffer(const char *buffer, int size);
+
+		// maximum number of payload bytes that are transferred together with the length in the first message
+		static const int first_chunk_size = 4096;
+
 		// Types derived from SerDesAble
 		template<typename T>
 		typename std::enable_if<std::is_base_of<SerDesAble,T>::value>::type // this method competed in overload resulution with template<typename T> get(T &val). "enable_if" lets this version win if a daughter class of SerDesAble is used.
@@ -307,14 +367,18 @@ namespace saftbus {
 		void save() const;
 		void restore() const;
 
+		// exchange the data and the read positions with other, e.g. to hand a call over to another thread without copying
+		void swap(Deserializer &other);
+
 	private:
 
 		// has to be called before first call to get()
 		void get_init() const;
 
-		std::vector<char> _data;
-		mutable std::vector<char>::const_iterator _iter;
-		mutable std::vector<char>::const_iterator _saved_iter;
+		typedef std::vector<char, DefaultInitAllocator<char> > Buffer;
+		Buffer _data;
+		mutable Buffer::const_iterator _iter;
+		mutable Buffer::const_iterator _saved_iter;
 	};
 
 
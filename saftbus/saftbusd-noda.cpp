@@ -121,6 +121,10 @@ int main(int argc, char *argv[]) {
 			return 1;
 		}
 
+		// The main thread owns the default loop. Then invoke_and_wait from the main thread
+		// executes functions that device threads invoke in the default loop while it waits.
+		saftbus::Loop::set_thread_default(&saftbus::Loop::get_default());
+
 		saftbus::ServerConnection server_connection(plugins_and_args);
 
 		// add allocator fillstate as additional info to be reported by Container::get_status()
@@ -83,17 +83,57 @@ namespace saftbus {
 		}
 	};
 
+	// The calling_client_id should be reset at end of scope.
+	// This struct guarantees that this is the case. The previous value is restored, 
+	// because the reply of a Service thread may be handled while another client request is in progress.
+	struct ClientID {
+		int &ref;
+		int previous;
+		ClientID(int &id_ref, int id_value) : ref(id_ref), previous(id_ref) { id_ref = id_value; }
+		~ClientID() { ref = previous; }
+	};
+
+	// operator is used to std::find a client based on the file descriptor
+	bool operator==(const std::unique_ptr<Client> &lhs, int rhs) {
+		return lhs->socket_fd == rhs;
+	}
+
+	// the state of a batch (see batch_call_object_id)
+	struct BatchProgress {
+		Deserializer call;   // one call of a batch
+		Serializer   result; // the reply to one call of a batch
+		std::vector<char> buffer;
+		uint32_t num_calls;
+		uint32_t next_call;
+	};
+
+	// A client request that waits for a Service in another thread (see Container::call_service).
+	// The client is not read again before the reply is sent, so that the replies keep their order.
+	struct PendingRequest {
+		Deserializer  received;
+		Serializer    send;
+		BatchProgress batch;
+	};
+
 	struct ServerConnection::Impl {
 		Container container_of_services;
 		std::vector<std::unique_ptr<Client> > clients;
-		Serializer   send;
-		Deserializer received;
+		Serializer    send;
+		Deserializer  received;
+		BatchProgress batch;
+		std::map<int, std::unique_ptr<PendingRequest> > pending_requests; // client fd -> batch that waits for a Service in another thread
 		int calling_client_id; // this is equal to the client id as long as a client request is handled
 		Impl(ServerConnection *connection) : container_of_services(connection), calling_client_id(-1) {}
 		~Impl() {
+			// Services in other threads may still finish calls, whose replies need the members of Impl
+			container_of_services.clear();
 		}
 		bool accept_client(int fd, int condition);
 		bool handle_client_request(int fd, int condition);
+		bool run_batch(int fd, Deserializer &batch_received, Serializer &batch_send, BatchProgress &batch);
+		void call_done(int fd, Serializer &reply);
+		void batch_call_done(int fd, Serializer &reply);
+		void resume_client(int fd);
 		void client_hung_up(int client_fd);
 	};
 
@@ -134,13 +174,7 @@ namespace saftbus {
 	}
 
 	bool ServerConnection::Impl::handle_client_request(int fd, int condition) {
-		// The calling_client_id should be reset to -1 at end of scope.
-		// This anonymous struct guarantees that this is the case
-		struct ClientID {
-			int &ref;
-			ClientID(int &id_ref, int id_value) : ref(id_ref) { id_ref = id_value; }
-			~ClientID() { ref = -1; }
-		} ccid(calling_client_id, fd); 
+		ClientID ccid(calling_client_id, fd); 
 
 		if (condition & (POLLIN|POLLHUP) ) {
 			// if POLLHUP is received, there may still be data inside the pipe
@@ -153,13 +187,41 @@ namespace saftbus {
 			}
 			unsigned saftbus_object_id;
 			received.get(saftbus_object_id);
-			if (!container_of_services.call_service(saftbus_object_id, fd, received, send)) { 
+			if (saftbus_object_id == async_call_object_id) {
+				// tagged request: the reply carries the same request id
+				uint32_t request_id;
+				received.get(request_id);
+				send.put(request_id);
+				received.get(saftbus_object_id);
+			}
+			bool deferred = false;
+			if (saftbus_object_id == batch_call_object_id) {
+				received.get(batch.num_calls);
+				send.put(batch.num_calls);
+				batch.next_call = 0;
+				if (!run_batch(fd, received, send, batch)) {
+					// keep the rest of the batch until the Service thread is done
+					std::unique_ptr<PendingRequest> request(new PendingRequest);
+					request->received.swap(received);
+					request->send.swap(send);
+					request->batch.num_calls = batch.num_calls;
+					request->batch.next_call = batch.next_call;
+					pending_requests[fd] = std::move(request);
+					deferred = true;
+				}
+			} else if (!container_of_services.call_service(saftbus_object_id, fd, received, send, 
+			                                               std::bind(&ServerConnection::Impl::call_done, this, fd, std::placeholders::_1), deferred)) { 
 				// call_service returns false if the service object was not found
 				// in this case an exception is sent to the Proxy 
 				send.put(saftbus::FunctionResult::EXCEPTION);
-				std::string what("remote call failed because service object was not found");
+				std::string what(object_not_found_message);
 				send.put(what);
 			} 
+			if (deferred) {
+				// The Service runs in another thread, saftbusd continues with other clients.
+				// This client is read again after the reply was sent (see resume_client).
+				return false;
+			}
 			if (!send.empty()) {
 				send.write_to(fd);
 			}
@@ -167,10 +229,62 @@ namespace saftbus {
 		return true;
 	}
 
-	// operator is used to std::find a client based on the file descriptor
-	bool operator==(const std::unique_ptr<Client> &lhs, int rhs) {
-		return lhs->socket_fd == rhs;
+	// Execute the calls of a batch (see batch_call_object_id) and put all their replies into one message.
+	// Return false if a call was handed over to a Service thread, batch_call_done continues after it.
+	bool ServerConnection::Impl::run_batch(int fd, Deserializer &batch_received, Serializer &batch_send, BatchProgress &batch) {
+		for (; batch.next_call < batch.num_calls; ++batch.next_call) {
+			batch_received.get(batch.buffer);
+			batch.call.read_from_buffer(batch.buffer.data(), batch.buffer.size());
+			unsigned saftbus_object_id;
+			batch.call.get(saftbus_object_id);
+			bool deferred = false;
+			if (!container_of_services.call_service(saftbus_object_id, fd, batch.call, batch.result, 
+			                                        std::bind(&ServerConnection::Impl::batch_call_done, this, fd, std::placeholders::_1), deferred)) { 
+				batch.result.put(saftbus::FunctionResult::EXCEPTION);
+				std::string what(object_not_found_message);
+				batch.result.put(what);
+			}
+			if (deferred) {
+				return false;
+			}
+			batch_send.put(batch.result.get_data());
+			batch.result.put_init();
+		}
+		return true;
+	}
+
+	// the reply of a call that was executed in a Service thread
+	void ServerConnection::Impl::call_done(int fd, Serializer &reply) {
+		if (!reply.empty()) {
+			reply.write_to(fd);
+		}
+		resume_client(fd);
 	}
+
+	// the reply of a batch call that was executed in a Service thread, continue with the rest of the batch
+	void ServerConnection::Impl::batch_call_done(int fd, Serializer &reply) {
+		auto pending = pending_requests.find(fd);
+		if (pending == pending_requests.end()) {
+			return;
+		}
+		PendingRequest &request = *pending->second;
+		request.send.put(reply.get_data());
+		++request.batch.next_call;
+		ClientID ccid(calling_client_id, fd);
+		if (run_batch(fd, request.received, request.send, request.batch)) {
+			request.send.write_to(fd);
+			pending_requests.erase(pending);
+			resume_client(fd);
+		}
+	}
+
+	void ServerConnection::Impl::resume_client(int fd) {
+		auto client = std::find(clients.begin(), clients.end(), fd);
+		if (client != clients.end()) {
+			(*client)->io_source = Loop::get_default().connect<IoSource>(std::bind(&ServerConnection::Impl::handle_client_request, this, std::placeholders::_1, std::placeholders::_2), fd, POLLIN | POLLHUP | POLLERR);
+		}
+	}
+
 	void ServerConnection::Impl::client_hung_up(int client_fd) 
 	{
 		auto removed_client = std::find(clients.begin(), clients.end(), client_fd);
@@ -23,11 +23,17 @@
 #include "plugins.hpp"
 #include "loop.hpp"
 #include "error.hpp"
+#include "signal_ring.hpp"
+#include "signal_queue.hpp"
 
 #include <string>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <deque>
+#include <mutex>
 #include <cassert>
+#include <cstring>
 #include <sstream>
 
 #include <unistd.h>
@@ -37,82 +43,221 @@ namespace saftbus {
 	struct Service::Impl {
 		int owner;
 		std::map<int, int> signal_fds_use_count;
+		std::map<int, std::set<std::pair<int,int> > > signal_filters; // signal fd -> (interface_no, signal_no) that are sent. No entry: all signals are sent
 		std::vector<std::string> interface_names;
 		std::string object_path;
 		uint64_t object_id;
 		std::function<void()> destruction_callback; // a funtion can be attatched here that is called whenever the service is destroyed
 		bool destroy_if_owner_quits; 
+		Container *container; // set when the service is inserted into a Container
+		Loop *loop;           // the Service is called in the thread of this Loop (see Loop::set_thread_default)
 		void remove_signal_fd(int fd);
 	};
 
+	// A saftbus object id consists of a slot number (plus one, because 0 is async_call_object_id)
+	// and the generation of the slot. The generation is incremented whenever the slot is freed, 
+	// so that the id of a removed object doesn't address the object that reuses its slot.
+	// Object ids stay below 2^31 because Proxies keep them in an int.
+	static const unsigned object_id_slot_bits       = 20;
+	static const unsigned object_id_slot_mask       = (1u<<object_id_slot_bits)-1;
+	static const unsigned object_id_generation_mask = (1u<<(31-object_id_slot_bits))-1;
+
+	// The client whose call is executed by a Service thread (see Container::call_service), -1 otherwise.
+	// In the thread of the Container, the ServerConnection knows the calling client.
+	static thread_local int service_thread_calling_client_id = -1;
+
 	struct Container::Impl {
 		std::vector<std::pair<std::string, std::unique_ptr<LibraryLoader> > > plugins;
-		unsigned generate_saftbus_object_id();
 		ServerConnection *connection;
-		std::map<unsigned, std::unique_ptr<Service> > objects; // Container owns the Service objects
-		std::map<std::string, unsigned> object_path_lookup_table; // maps object_path to saftbus_object_id
+		Loop *loop; // the Loop of saftbusd. Services that were created in other threads are called in their own Loop
+		struct Slot {
+			std::unique_ptr<Service> service; // Container owns the Service objects, nullptr if the slot is free
+			unsigned generation;
+			uint64_t creation_no;             // children are always created after their parents
+		};
+		std::vector<Slot> slots;           // indexed by the slot number of the saftbus_object_id
+		std::deque<unsigned> free_slots;   // reused in FIFO order, so that a generation wraps around as late as possible
+		uint64_t creation_counter;
+		std::map<uint64_t, unsigned> creation_order;                 // creation_no -> saftbus_object_id of all objects
+		std::unordered_map<std::string, unsigned> object_path_lookup_table; // maps object_path to saftbus_object_id
+		std::unordered_map<int, std::map<uint64_t, unsigned> > owned_objects; // owner -> (creation_no -> saftbus_object_id)
+		std::unordered_map<int, std::set<unsigned> > signal_fd_objects;     // signal fd -> saftbus_object_ids that send signals to it
 		std::vector<Service*> removed_services;
 		std::map<std::string, std::function<std::string(void)> > additional_info_callbacks; // allow plugins to add additional info to be shown by "saftbus-ctl -s"
+		std::map<int, std::unique_ptr<SignalRing> > signal_rings; // optional shared memory transport for some signal fds
+		std::map<int, std::unique_ptr<SignalQueue> > signal_queues; // non-blocking outbound queue for each signal fd
+		// Buffers that carry signals from Service threads to the thread of saftbusd (see Service::emit).
+		// They are recycled, so that a signal doesn't allocate memory.
+		std::mutex signal_buffers_mutex;
+		std::vector<std::unique_ptr<std::vector<char> > > signal_buffers;
+		std::vector<std::vector<char>*> free_signal_buffers;
+		std::vector<char> *get_signal_buffer() {
+			std::lock_guard<std::mutex> lock(signal_buffers_mutex);
+			if (free_signal_buffers.empty()) {
+				signal_buffers.push_back(std::unique_ptr<std::vector<char> >(new std::vector<char>));
+				return signal_buffers.back().get();
+			}
+			std::vector<char> *buffer = free_signal_buffers.back();
+			free_signal_buffers.pop_back();
+			return buffer;
+		}
+		void put_signal_buffer(std::vector<char> *buffer) {
+			std::lock_guard<std::mutex> lock(signal_buffers_mutex);
+			free_signal_buffers.push_back(buffer);
+		}
+		SignalQueue *get_signal_queue(int fd) {
+			auto &queue = signal_queues[fd];
+			if (!queue) {
+				queue.reset(new SignalQueue(fd, *loop));
+			}
+			return queue.get();
+		}
+		// return nullptr if there is no object with this id (anymore)
+		Service *find(unsigned saftbus_object_id) {
+			unsigned slot_no = (saftbus_object_id & object_id_slot_mask) - 1;
+			if (slot_no >= slots.size()) {
+				return nullptr;
+			}
+			auto &slot = slots[slot_no];
+			if (slot.generation != (saftbus_object_id >> object_id_slot_bits)) {
+				return nullptr;
+			}
+			return slot.service.get();
+		}
+		Slot &get_slot(unsigned saftbus_object_id) {
+			return slots[(saftbus_object_id & object_id_slot_mask) - 1];
+		}
+		unsigned insert(std::unique_ptr<Service> service) {
+			unsigned slot_no;
+			if (!free_slots.empty()) {
+				slot_no = free_slots.front();
+				free_slots.pop_front();
+			} else {
+				if (slots.size() == object_id_slot_mask - 1) {
+					throw saftbus::Error("cannot create more saftbus objects");
+				}
+				slot_no = slots.size();
+				slots.push_back(Slot());
+				slots.back().generation = 0;
+			}
+			auto &slot = slots[slot_no];
+			unsigned saftbus_object_id = (slot.generation << object_id_slot_bits) | (slot_no + 1);
+			slot.creation_no = creation_counter++;
+			slot.service     = std::move(service);
+			creation_order[slot.creation_no] = saftbus_object_id;
+			if (slot.service->d->owner != -1) {
+				owned_objects[slot.service->d->owner][slot.creation_no] = saftbus_object_id;
+			}
+			return saftbus_object_id;
+		}
+		// Run function in the thread of the Service and wait for it. Everything that may touch the driver object 
+		// behind a Service (calls, destruction callback, destructor) has to run in that thread.
+		void run_in_service_thread(Service *service, const std::function<void()> &function) {
+			if (service->d->loop == loop) {
+				function();
+			} else {
+				service->d->loop->invoke_and_wait(function);
+			}
+		}
+		void call_destruction_callback(Service *service) {
+			if (service->d->destruction_callback) {
+				run_in_service_thread(service, service->d->destruction_callback);
+			}
+		}
+		// The tables of the Container are only used in its own thread. 
+		// A Service thread that creates or removes objects waits until the Container has done it.
+		void run_in_container_thread(const std::function<void()> &function) {
+			loop->invoke_and_wait(function);
+		}
+		// remove the Services that destroyed themselves during a call (see Container::destroy_service)
+		void remove_destroyed_services(Container *container) {
+			for (auto &s: removed_services) {
+				call_destruction_callback(s);
+				try {
+					container->remove_object(s->d->object_path);
+				} catch(std::runtime_error &e) {
+					std::cerr << "Exception in " << __FUNCTION__ << " : " << e.what() << std::endl;
+				}
+			}
+			removed_services.clear();
+		}
+		unsigned create_object(Container *container, const std::string &object_path, std::unique_ptr<Service> service, Loop *service_loop);
+		// remove the object from all tables, free its slot and destroy the Service
+		void erase(unsigned saftbus_object_id) {
+			auto &slot = get_slot(saftbus_object_id);
+			std::unique_ptr<Service> service = std::move(slot.service);
+			object_path_lookup_table.erase(service->d->object_path);
+			creation_order.erase(slot.creation_no);
+			set_owner(service.get(), -1);
+			for (auto &fd_use_count: service->d->signal_fds_use_count) {
+				auto objects = signal_fd_objects.find(fd_use_count.first);
+				if (objects != signal_fd_objects.end()) {
+					objects->second.erase(saftbus_object_id);
+				}
+			}
+			slot.generation = (slot.generation + 1) & object_id_generation_mask;
+			free_slots.push_back((saftbus_object_id & object_id_slot_mask) - 1);
+			run_in_service_thread(service.get(), [&service]() { service.reset(); });
+		}
+		void set_owner(Service *service, int owner) {
+			int old_owner = service->d->owner;
+			service->d->owner = owner;
+			if (!service->d->container) {
+				return; // not yet in the Container, create_object adds it to owned_objects
+			}
+			unsigned saftbus_object_id = service->d->object_id;
+			uint64_t creation_no = get_slot(saftbus_object_id).creation_no;
+			if (old_owner != -1) {
+				auto owned = owned_objects.find(old_owner);
+				if (owned != owned_objects.end()) {
+					owned->second.erase(creation_no);
+					if (owned->second.empty()) {
+						owned_objects.erase(owned);
+					}
+				}
+			}
+			if (owner != -1) {
+				owned_objects[owner][creation_no] = saftbus_object_id;
+			}
+		}
+		static bool is_child(const std::string &child_path, const std::string &object_path) {
+			return child_path.size() > object_path.size() && 
+			       child_path[object_path.size()] == '/' &&
+			       child_path.compare(0, object_path.size(), object_path) == 0;
+		}
 		void reset_children_first(const std::string &object_path) {
 			if (object_path == "/saftbus") return;
 			bool found_child = false;
-			for (auto &obj: objects) {
-				if (obj.second &&
-					obj.second->d->object_path.find(object_path) == 0 && 
-					obj.second->d->object_path.size() > object_path.size() && 
-					obj.second->d->object_path[object_path.size()] == '/') {
+			for (auto &slot: slots) {
+				if (slot.service && is_child(slot.service->d->object_path, object_path)) {
 					found_child = true;
-					reset_children_first(obj.second->d->object_path);
+					reset_children_first(slot.service->d->object_path);
 				}
 			}
 			if (!found_child) {
-				auto id = object_path_lookup_table[object_path];
-				objects[id].reset();
-				object_path_lookup_table.erase(object_path);
+				erase(object_path_lookup_table[object_path]);
 			}
-
 		}
 		void clear() {
 			// Make sure that service objects are destroyed in the opposite order (youngest object first).
-			// The std::map "objects" is sorted after object id, which is increasing for all created objects.
+			// creation_order is sorted after creation_no, which is increasing for all created objects.
 			// starting with the last object in the map, the correct destruction order is assured.
-			// the lowest object_id is 1 and /saftbus has it. 
-			while(objects.size()>1) {
-				auto last = objects.end();
-				--last;
-				if (last->second->d->destruction_callback) {
-					last->second->d->destruction_callback();
-				}
-				reset_children_first(last->second->d->object_path);
-				// erase all reset-ed entries
-				for (;;) {
-					bool found = false;
-					unsigned id;
-					for (auto &obj: objects) {
-						if (!obj.second) {
-							id = obj.first;
-							found = true;
-							break;
-						}
-					}
-					if (found) {
-						objects.erase(id);
-					} else {
-						break;
-					}
+			// the lowest creation_no is 0 and /saftbus has it. 
+			while(creation_order.size()>1) {
+				unsigned saftbus_object_id = creation_order.rbegin()->second;
+				call_destruction_callback(find(saftbus_object_id));
+				Service *service = find(saftbus_object_id);
+				if (service) { // the destruction callback may have removed the object already
+					reset_children_first(service->d->object_path);
 				}
 			}
-			object_path_lookup_table.clear();
-
 		}
-		Impl() {}
+		Impl() : creation_counter(0) {}
 		~Impl()  {
 			clear();
 		}
 	};
 
-
-
 	Service::Service(const std::vector<std::string> &interface_names, std::function<void()> destruction_callback, bool destroy_if_owner_quits)
 		: d(new Impl)
 	{
@@ -120,6 +265,8 @@ namespace saftbus {
 		d->interface_names = interface_names;
 		d->destruction_callback = destruction_callback;
 		d->destroy_if_owner_quits = destroy_if_owner_quits;
+		d->container = nullptr;
+		d->loop = nullptr;
 	}
 	Service::~Service() {
 	}
@@ -131,10 +278,14 @@ namespace saftbus {
 		return d->owner != -1;
 	}
 	void Service::set_owner(int owner) {
-		d->owner = owner;
+		if (d->container) {
+			d->container->d->run_in_container_thread([this, owner]() { d->container->d->set_owner(this, owner); });
+		} else {
+			d->owner = owner;
+		}
 	}
 	void Service::release_owner() {
-		d->owner = -1;
+		set_owner(-1);
 	}
 	bool Service::has_destruction_callback() {
 		if (d->destruction_callback) {
@@ -178,13 +329,56 @@ namespace saftbus {
 		if (found_use_count != signal_fds_use_count.end()) {
 			signal_fds_use_count.erase(fd);
 		}
+		signal_filters.erase(fd);
 	}
 
 	void Service::emit(Serializer &send)
 	{
+		if (d->container && &Loop::get_default() != d->container->d->loop) {
+			// Signals from a driver that runs in its own thread are sent by the thread of saftbusd.
+			// The Service may be gone when the signal is sent, look it up again.
+			Container *container = d->container;
+			unsigned saftbus_object_id = d->object_id;
+			std::vector<char> *buffer = container->d->get_signal_buffer();
+			buffer->swap(send._data); // send gets the (empty) recycled buffer
+			send.put_init();
+			container->d->loop->invoke([container, saftbus_object_id, buffer]() {
+				Service *service = container->d->find(saftbus_object_id);
+				if (service) {
+					Serializer &signal = get_signal_serializer();
+					signal._data.swap(*buffer);
+					service->emit(signal);
+					signal._data.swap(*buffer); // both buffers keep their capacity
+				}
+				container->d->put_signal_buffer(buffer);
+			});
+			return;
+		}
+		std::pair<int,int> interface_signal_no;
+		if (!d->signal_filters.empty() && send._data.size() >= 3*sizeof(int)) {
+			// every signal starts with object_id, interface_no, signal_no
+			memcpy(&interface_signal_no.first,  &send._data[1*sizeof(int)], sizeof(int));
+			memcpy(&interface_signal_no.second, &send._data[2*sizeof(int)], sizeof(int));
+		}
 		for (auto &fd_use_count: d->signal_fds_use_count) {
 			if (fd_use_count.second > 0) { // only send data if use count is > 0
 				int fd = fd_use_count.first;
+				if (!d->signal_filters.empty()) {
+					auto filter = d->signal_filters.find(fd);
+					if (filter != d->signal_filters.end() && filter->second.find(interface_signal_no) == filter->second.end()) {
+						continue; // no Proxy on the other side of fd is interested in this signal
+					}
+				}
+				if (d->container) {
+					auto ring = d->container->d->signal_rings.find(fd);
+					if (ring != d->container->d->signal_rings.end() && ring->second->push(send)) {
+						continue; // signal is in shared memory, no need to use the socket
+					}
+					// A slow client must not stall the other subscribers (or the whole saftbusd).
+					// The queue sends without blocking and keeps what doesn't fit into the socket.
+					d->container->d->get_signal_queue(fd)->push(send);
+					continue;
+				}
 				struct pollfd pfd;
 				pfd.fd = fd;
 				pfd.events = POLLOUT;
@@ -198,6 +392,13 @@ namespace saftbus {
 		send.put_init();                   // <- here
 	}
 
+	Serializer &Service::get_signal_serializer()
+	{
+		// The buffer lives in libsaftbus, not in a plugin that may be unloaded while the thread runs.
+		static thread_local Serializer signal_serializer;
+		return signal_serializer;
+	}
+
 	int Service::get_object_id() 
 	{
 		return d->object_id;
@@ -285,9 +486,7 @@ namespace saftbus {
 					received.get(object_path);
 					bool function_call_result = true;
 					Service* service = d->removal_helper(object_path);
-					if (service->d->destruction_callback) {
-						service->d->destruction_callback();
-					}
+					d->d->call_destruction_callback(service);
 					if (d->d->object_path_lookup_table.find(object_path) != d->d->object_path_lookup_table.end()) { // it may be that destruction callback already removed the object
 						d->remove_object(object_path);
 					}
@@ -303,6 +502,37 @@ namespace saftbus {
 					send.put(saftbus::FunctionResult::RETURN);
 					send.put(function_call_result);
 				} return;
+				case 7: { // Container::attach_signal_ring (Hand-written. It will be called by SignalGroup if a SignalRing is used)
+					int signal_group_fd;
+					received.get(signal_group_fd);
+					int memfd   = recvfd(client_fd);
+					int eventfd = recvfd(client_fd);
+					bool function_call_result = d->attach_signal_ring(signal_group_fd, memfd, eventfd);
+					send.put(saftbus::FunctionResult::RETURN);
+					send.put(function_call_result);
+				} return;
+				case 8: { // Container::set_signal_filter (Hand-written. It will be called by Proxy::ignore_unconnected_signals, no response is sent)
+					unsigned saftbus_object_id;
+					int signal_group_fd;
+					bool filter;
+					std::vector<int> interface_nos, signal_nos;
+					received.get(saftbus_object_id);
+					received.get(signal_group_fd);
+					received.get(filter);
+					received.get(interface_nos);
+					received.get(signal_nos);
+					d->set_signal_filter(saftbus_object_id, signal_group_fd, filter, interface_nos, signal_nos);
+				} return;
+				case 9: { // Container::lookup_object (Hand-written. It will be called by the constructor of call-only Proxies)
+					std::string object_path;
+					received.get(object_path);
+					std::vector<std::string> interface_names;
+					received.get(interface_names);
+					std::map<std::string, int> interface_name2no_map;
+					int saftbus_object_id = d->lookup_object(object_path, interface_names, interface_name2no_map);
+					send.put(saftbus_object_id);
+					send.put(interface_name2no_map);
+				} return;
 			};
 
 		};
@@ -318,19 +548,10 @@ namespace saftbus {
 	}
 
 
-	// generate a unique object_id != 0
-	unsigned Container::Impl::generate_saftbus_object_id() {
-		static unsigned saftbus_object_id_generator = 1;
-		while ((objects.find(saftbus_object_id_generator) != objects.end()) ||
-		        saftbus_object_id_generator == 0) {
-			++saftbus_object_id_generator;
-		}
-		return saftbus_object_id_generator++;
-	}
-
 	Container::Container(ServerConnection *connection) 
 		: d(new Impl)
 	{
+		d->loop = &Loop::get_default();
 		unsigned object_id = create_object("/saftbus", std::move(std::unique_ptr<Container_Service>(new Container_Service(this))));
 		assert(object_id == 1); // the entier system relies on having Container_Service at object_id 1	
 		d->connection = connection;
@@ -343,40 +564,47 @@ namespace saftbus {
 
 	unsigned Container::create_object(const std::string &object_path, std::unique_ptr<Service> service)
 	{
-		if (d->object_path_lookup_table.find(object_path) != d->object_path_lookup_table.end()) {
+		Loop *service_loop = &Loop::get_default(); // a driver that runs in its own thread creates its Services in that thread
+		unsigned saftbus_object_id = 0;
+		d->run_in_container_thread([&]() { saftbus_object_id = d->create_object(this, object_path, std::move(service), service_loop); });
+		return saftbus_object_id;
+	}
+
+	unsigned Container::Impl::create_object(Container *container, const std::string &object_path, std::unique_ptr<Service> service, Loop *service_loop)
+	{
+		if (object_path_lookup_table.find(object_path) != object_path_lookup_table.end()) {
 			// we have already registered an object under this object path
 			return 0;
 		}
-		unsigned saftbus_object_id = d->generate_saftbus_object_id();
-		service->d->object_id = saftbus_object_id;
-		auto insertion_result = d->objects.insert(std::make_pair(saftbus_object_id, std::move(service)));
-		auto  insertion_took_place  = insertion_result.second;
-		auto &inserted_object       = insertion_result.first->second; 
-		if (insertion_took_place) {
-			inserted_object->d->object_path = object_path; // set the object_path of the Service object
-			d->object_path_lookup_table[object_path] = saftbus_object_id;
-			return saftbus_object_id;
-		}
-		return 0;
+		Service *inserted_object = service.get();
+		inserted_object->d->object_path = object_path; // set the object_path of the Service object
+		unsigned saftbus_object_id = insert(std::move(service));
+		inserted_object->d->object_id = saftbus_object_id;
+		inserted_object->d->container = container;
+		inserted_object->d->loop = service_loop;
+		object_path_lookup_table[object_path] = saftbus_object_id;
+		return saftbus_object_id;
 	}
 
 	Service* Container::get_object(const std::string &object_path)
 	{
-		auto find_result = d->object_path_lookup_table.find(object_path);
-		if (find_result == d->object_path_lookup_table.end()) {
-			std::string msg = "cannot get object because its object_path \"";
-			msg.append(object_path);
-			msg.append("\" was not found");
-			throw saftbus::Error(saftbus::Error::INVALID_ARGS, msg);
-		}
-		auto object_id = find_result->second;
-		auto &service = d->objects[object_id];
-		return service.get();
+		Service *service = nullptr;
+		d->run_in_container_thread([&]() {
+			auto find_result = d->object_path_lookup_table.find(object_path);
+			if (find_result == d->object_path_lookup_table.end()) {
+				std::string msg = "cannot get object because its object_path \"";
+				msg.append(object_path);
+				msg.append("\" was not found");
+				throw saftbus::Error(saftbus::Error::INVALID_ARGS, msg);
+			}
+			service = d->find(find_result->second);
+		});
+		return service;
 	}
 
 	void Container::destroy_service(Service *service) {
 		if (get_calling_client_id() != -1) {
-			d->removed_services.push_back(service);
+			d->run_in_container_thread([&]() { d->removed_services.push_back(service); });
 		} else {
 			try {
 				remove_object(service->d->object_path);
@@ -398,10 +626,9 @@ namespace saftbus {
 			msg.append("\" because its object_path was not found");
 			throw saftbus::Error(saftbus::Error::INVALID_ARGS, msg);
 		}
-		auto object_id = find_result->second;
-		auto &service = d->objects[object_id];
+		Service *service = d->find(find_result->second);
 		if (service->d->owner != -1) { // the service is owned
-			if (service->d->owner != d->connection->get_calling_client_id()) {
+			if (service->d->owner != get_calling_client_id()) {
 				std::ostringstream msg;
 				msg << "cannot remove object \"" << object_path << "\" because it owned by other client " << service->d->owner;
 				throw saftbus::Error(saftbus::Error::INVALID_ARGS, msg.str());
@@ -421,10 +648,9 @@ namespace saftbus {
 			    other_path.find(object_path)==0 &&        // check if other_path starts with object_path
 			    other_path.size() > object_path.size() && // check if other_path is longer then object_path (child object paths are always longer)
 			    other_path[object_path.size()] == '/' ) { // and the first non-commom character in a child path is '/', as in "/parent/child".
-				auto object_id = object.second;
-				auto &service = d->objects[object_id];
+				Service *service = d->find(object.second);
 				if (service->d->owner != -1) { // the service is owned
-					if (service->d->owner != d->connection->get_calling_client_id()) {
+					if (service->d->owner != get_calling_client_id()) {
 						std::ostringstream msg;
 						msg << "cannot remove object \"" << object_path << "\" because child object \"" << other_path << "\" is owned by other client " << service->d->owner;
 						throw saftbus::Error(saftbus::Error::INVALID_ARGS, msg.str());
@@ -432,30 +658,37 @@ namespace saftbus {
 				}
 			}
 		}
-		return d->objects[d->object_path_lookup_table[object_path]].get();
+		return service;
 	}
 
 	bool Container::remove_object(const std::string &object_path)
 	{
-		removal_helper(object_path);
-		auto object_id = d->object_path_lookup_table[object_path];
-		d->object_path_lookup_table.erase(object_path);
-		d->objects.erase(object_id);
+		int calling_client_id = get_calling_client_id();
+		d->run_in_container_thread([&]() {
+			// the ownership check in removal_helper needs the client of the calling thread
+			int saved_calling_client_id = service_thread_calling_client_id;
+			service_thread_calling_client_id = calling_client_id;
+			try {
+				removal_helper(object_path);
+				d->erase(d->object_path_lookup_table[object_path]);
+			} catch (...) {
+				service_thread_calling_client_id = saved_calling_client_id;
+				throw;
+			}
+			service_thread_calling_client_id = saved_calling_client_id;
+		});
 		return false;
 	}
 
 
-	int Container::register_proxy(const std::string &object_path, const std::vector<std::string> interface_names, std::map<std::string, int> &interface_name2no_map, int client_fd, int signal_group_fd)
+	int Container::lookup_object(const std::string &object_path, const std::vector<std::string> &interface_names, std::map<std::string, int> &interface_name2no_map)
 	{
 		auto find_result = d->object_path_lookup_table.find(object_path);
 		if (find_result != d->object_path_lookup_table.end()) {
 			unsigned saftbus_object_id = find_result->second;
-			auto find_result = d->objects.find(saftbus_object_id);
-			assert(find_result != d->objects.end()); // if this cannot be found, the lookup table is not correct
-			auto &service    = find_result->second;
+			Service *service = d->find(saftbus_object_id);
+			assert(service != nullptr); // if this cannot be found, the lookup table is not correct
 			if (service->get_interface_name2no_map(interface_names, interface_name2no_map)) { //returns false if not all requested interfaces are implemented
-				service->d->signal_fds_use_count[signal_group_fd]++;
-				d->connection->register_signal_id_for_client(client_fd, signal_group_fd);
 				return saftbus_object_id;
 			}
 			// not all requested interfaces are implemented => return -1
@@ -463,83 +696,171 @@ namespace saftbus {
 		}
 		return 0;
 	}
+	int Container::register_proxy(const std::string &object_path, const std::vector<std::string> interface_names, std::map<std::string, int> &interface_name2no_map, int client_fd, int signal_group_fd)
+	{
+		int saftbus_object_id = lookup_object(object_path, interface_names, interface_name2no_map);
+		if (saftbus_object_id != 0 && saftbus_object_id != -1) {
+			Service *service = d->find(saftbus_object_id);
+			service->d->signal_fds_use_count[signal_group_fd]++;
+			d->signal_fd_objects[signal_group_fd].insert(saftbus_object_id);
+			service->d->signal_filters.erase(signal_group_fd); // the new Proxy wants all signals
+			d->connection->register_signal_id_for_client(client_fd, signal_group_fd);
+		}
+		return saftbus_object_id;
+	}
 	void Container::unregister_proxy(unsigned saftbus_object_id, int client_fd, int signal_group_fd)
 	{
-		auto find_result = d->objects.find(saftbus_object_id);
-		if (find_result == d->objects.end()) {
+		Service *service = d->find(saftbus_object_id);
+		if (service == nullptr) {
 			// std::cerr << "object id " << saftbus_object_id << " already gone" << std::endl;
 			return;
 		}
-		auto    &service    = find_result->second;
 		service->d->signal_fds_use_count[signal_group_fd]--;
 		d->connection->unregister_signal_id_for_client(client_fd, signal_group_fd);
 		if (service->d->signal_fds_use_count[signal_group_fd] == 0) {
 			service->d->signal_fds_use_count.erase(signal_group_fd);
+			service->d->signal_filters.erase(signal_group_fd);
+			d->signal_fd_objects[signal_group_fd].erase(saftbus_object_id);
+		}
+	}
+
+	void Container::set_signal_filter(unsigned saftbus_object_id, int signal_group_fd, bool filter, const std::vector<int> &interface_nos, const std::vector<int> &signal_nos)
+	{
+		Service *service = d->find(saftbus_object_id);
+		if (service == nullptr || service->d->signal_fds_use_count.count(signal_group_fd) == 0) {
+			return; // object or Proxy already gone
+		}
+		auto &signal_filters = service->d->signal_filters;
+		if (!filter) {
+			signal_filters.erase(signal_group_fd);
+			return;
+		}
+		auto &wanted = signal_filters[signal_group_fd];
+		wanted.clear();
+		for (unsigned i = 0; i < interface_nos.size() && i < signal_nos.size(); ++i) {
+			wanted.insert(std::make_pair(interface_nos[i], signal_nos[i]));
 		}
 	}
 
 
+	// A call that runs in the thread of a Service. The Container thread doesn't wait for it.
+	struct DeferredCall {
+		Deserializer received;
+		Serializer send;
+		std::function<void(Serializer &reply)> done;
+	};
+
 	bool Container::call_service(unsigned saftbus_object_id, int client_fd, Deserializer &received, Serializer &send) {
-		auto find_result = d->objects.find(saftbus_object_id);
-		if (find_result == d->objects.end()) {
+		Service *service = d->find(saftbus_object_id);
+		if (service == nullptr) {
 			return false;
 		}
-		auto &service = find_result->second;
-		service->call(client_fd, received, send);
+		if (service->d->loop == d->loop) {
+			service->call(client_fd, received, send);
+		} else {
+			service->d->loop->invoke_and_wait([&]() { 
+				service_thread_calling_client_id = client_fd;
+				service->call(client_fd, received, send);
+				service_thread_calling_client_id = -1;
+			});
+		}
+		d->remove_destroyed_services(this);
+		return true;
+	}
 
-		for (auto &s: d->removed_services) {
-			if (s->d->destruction_callback) {
-				s->d->destruction_callback();
-			}
-			try {
-				remove_object(s->d->object_path);
-			} catch(std::runtime_error &e) {
-				std::cerr << "Exception in " << __FUNCTION__ << " : " << e.what() << std::endl;
-			}
+	bool Container::call_service(unsigned saftbus_object_id, int client_fd, Deserializer &received, Serializer &send, const std::function<void(Serializer &reply)> &done, bool &deferred) {
+		Service *service = d->find(saftbus_object_id);
+		deferred = false;
+		if (service == nullptr) {
+			return false;
+		}
+		if (service->d->loop == d->loop) {
+			service->call(client_fd, received, send);
+			d->remove_destroyed_services(this);
+			return true;
 		}
-		d->removed_services.clear();
 
+		// The Service is destroyed in its own thread, after all calls that were handed over before.
+		// So it is still there when the call is executed.
+		std::shared_ptr<DeferredCall> call = std::make_shared<DeferredCall>();
+		call->received.swap(received);
+		call->send.swap(send);
+		call->done = done;
+		Container *container = this;
+		service->d->loop->invoke([container, service, client_fd, call]() {
+			service_thread_calling_client_id = client_fd;
+			service->call(client_fd, call->received, call->send);
+			service_thread_calling_client_id = -1;
+			// Signals that the call emitted were handed over to the Container thread already, 
+			// they reach the client before the reply.
+			container->d->loop->invoke([container, client_fd, call]() {
+				service_thread_calling_client_id = client_fd;
+				container->d->remove_destroyed_services(container);
+				service_thread_calling_client_id = -1;
+				call->done(call->send);
+			});
+		});
+		deferred = true;
 		return true;
 	}
 
 	void Container::remove_signal_fd(int fd)
 	{
-		for(auto &service: d->objects) {
-			service.second->d->remove_signal_fd(fd);
+		// only the objects that send signals to fd are touched
+		auto objects = d->signal_fd_objects.find(fd);
+		if (objects != d->signal_fd_objects.end()) {
+			for (auto saftbus_object_id: objects->second) {
+				Service *service = d->find(saftbus_object_id);
+				if (service) {
+					service->d->remove_signal_fd(fd);
+				}
+			}
+			d->signal_fd_objects.erase(objects);
 		}
+		d->signal_rings.erase(fd);
+		d->signal_queues.erase(fd);
 	}
 
-
-	// operator is used to std::find a Service based on owner, where the owner is identified by file descriptor (fd) of the client socket
-	bool operator==(std::pair<const unsigned int, std::unique_ptr<saftbus::Service> > &p, const int fd) {
-		return p.second->d->owner == fd;
+	bool Container::attach_signal_ring(int signal_group_fd, int memfd, int eventfd)
+	{
+		std::unique_ptr<SignalRing> ring(new SignalRing(memfd, eventfd));
+		if (!ring->valid()) {
+			return false;
+		}
+		d->signal_rings[signal_group_fd] = std::move(ring);
+		return true;
 	}
+
+
 	void Container::client_hung_up(int fd) {
 		// There may be parent-child relations between service objects it must be ensured 
 		// that children are always destroyed before their parents.
-		// All service objects get an object id which is always increasing.
-		// Thus, children always have larger numbers then their parents.
+		// Children are always created after their parents.
 		// Thus a viable strategy to remove children before parents is
-		// the use of reverse iterators when selecting the owned service objects.
-		// This works because iterating a map with object ids as key value is sorted.
+		// to always select the youngest of the owned service objects.
+		// owned_objects contains only the objects of this client, sorted after creation_no.
 		for(;;) {
-			auto iter = std::find(d->objects.rbegin(), d->objects.rend(), fd);
-			if (iter == d->objects.rend()) {
+			auto owned = d->owned_objects.find(fd);
+			if (owned == d->owned_objects.end() || owned->second.empty()) {
 				break;
 			}
-			if (iter->second->d->destruction_callback) {
-				iter->second->d->destruction_callback();
+			unsigned saftbus_object_id = owned->second.rbegin()->second;
+			d->call_destruction_callback(d->find(saftbus_object_id));
+			Service *service = d->find(saftbus_object_id);
+			if (service == nullptr) {
+				continue; // the destruction callback already removed the object
 			}
-			if (iter->second->d->destruction_callback && iter->second->d->destroy_if_owner_quits) {
+			if (service->d->destruction_callback && service->d->destroy_if_owner_quits) {
 				try {
-					remove_object(iter->second->get_object_path());
+					remove_object(service->get_object_path());
+					continue;
 				} catch(std::runtime_error &e) {
 					std::cerr << "Exception in " << __FUNCTION__ << " : " << e.what() << std::endl;
 				}
-			} else {
-				// if there is no destruction_callback, release object from clients ownership (because the client hung up)
-				iter->second->d->owner = -1;
 			}
+			// if there is no destruction_callback (or the object cannot be removed), 
+			// release object from clients ownership (because the client hung up)
+			d->set_owner(service, -1);
 		} 
 	}
 
@@ -579,6 +900,9 @@ namespace saftbus {
 	}
 
 	int Container::get_calling_client_id() const {
+		if (service_thread_calling_client_id != -1) {
+			return service_thread_calling_client_id;
+		}
 		return d->connection->get_calling_client_id();
 	}
 
@@ -597,15 +921,16 @@ namespace saftbus {
 
 	SaftbusInfo Container::get_status() {
 		SaftbusInfo result;
-		for (auto &obj: d->objects) {
+		for (auto &obj: d->creation_order) {
+			Service *service = d->find(obj.second);
 			SaftbusInfo::ObjectInfo object_info;
-			object_info.object_id = obj.first;
-			object_info.object_path = obj.second->d->object_path;
-			object_info.interface_names = obj.second->d->interface_names;
-			object_info.signal_fds_use_count = obj.second->d->signal_fds_use_count;
-			object_info.owner = obj.second->d->owner;
-			object_info.has_destruction_callback = obj.second->d->destruction_callback?true:false;
-			object_info.destroy_if_owner_quits = obj.second->d->destroy_if_owner_quits;
+			object_info.object_id = obj.second;
+			object_info.object_path = service->d->object_path;
+			object_info.interface_names = service->d->interface_names;
+			object_info.signal_fds_use_count = service->d->signal_fds_use_count;
+			object_info.owner = service->d->owner;
+			object_info.has_destruction_callback = service->d->destruction_callback?true:false;
+			object_info.destroy_if_owner_quits = service->d->destroy_if_owner_quits;
 			result.object_infos.push_back(object_info);
 		}
 		for (auto &client: d->connection->get_client_info()) {
@@ -613,6 +938,18 @@ namespace saftbus {
 			client_info.process_id = client.process_id;
 			client_info.client_fd  = client.client_fd;
 			client_info.signal_fds = client.signal_fds;
+			for (auto &signal_fd: client.signal_fds) {
+				uint64_t dropped = 0;
+				auto ring = d->signal_rings.find(signal_fd.first);
+				if (ring != d->signal_rings.end()) {
+					dropped += ring->second->get_dropped();
+				}
+				auto queue = d->signal_queues.find(signal_fd.first);
+				if (queue != d->signal_queues.end()) {
+					dropped += queue->second->get_dropped();
+				}
+				client_info.dropped_signals[signal_fd.first] = dropped;
+			}
 			result.client_infos.push_back(client_info);
 		}
 		for (auto &name_loader: d->plugins) {
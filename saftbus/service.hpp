@@ -53,7 +53,6 @@ namespace saftbus {
 		struct Impl; std::unique_ptr<Impl> d;
 		friend class Container;
 		friend class Container_Service;
-		friend bool operator==(std::pair<const unsigned int, std::unique_ptr<saftbus::Service> > &p, const int fd);
 	public:
 		/// @brief construct a Service that can be inserted into a saftbus::Container
 		///
@@ -125,6 +124,13 @@ namespace saftbus {
 		///         - the signal number (type int) of the signal being sent.
 		void emit(Serializer &send);
 
+		/// @brief A Serializer that can be reused for signals, so that emitting a signal doesn't allocate memory.
+		///
+		/// There is one of these per thread. emit leaves it empty, but it keeps its capacity.
+		/// Used by the signal dispatch functions generated by saftbus-gen.
+		/// @return a reference to the signal Serializer of the calling thread
+		static Serializer &get_signal_serializer();
+
 		// @brief get the object id of this Service object in a saftbus::Container
 		// @return the object id of this Service object in a saftbus::Container
 		int get_object_id();
@@ -149,6 +155,7 @@ namespace saftbus {
 		// @saftbus-default-object-path /saftbus
 		struct Impl; std::unique_ptr<Impl> d;
 		friend class Container_Service;
+		friend class Service;
 	public:
 		
 		/// @brief create a Container for saftbus::Service objects
@@ -184,10 +191,42 @@ namespace saftbus {
 		/// @param client_fd the file descriptor to the calling client
 		/// @param received data that came from the client and is deserialized into function arguments
 		/// @param send     serialized return values that will be sent back to the client
-		/// @return false if the saftbus_object_id is unknown
+		/// @return false if the saftbus_object_id is unknown (or belongs to an object that was removed)
+		///
+		/// A Service that runs in another thread (see Loop::set_thread_default) is called in that thread 
+		/// and the Container waits for it.
 		bool call_service(unsigned saftbus_object_id, int client_fd, Deserializer &received, Serializer &send);
+		/// @brief call a Service identified by the saftbus_object_id without waiting for Services in other threads
+		///
+		/// If the Service runs in another thread, the call is handed over to that thread and deferred is set to true. 
+		/// received and send are swapped into the call (they are empty afterwards). When the call is finished, 
+		/// done is called in the thread of the Container with the reply. Signals that the Service emitted 
+		/// during the call are sent before done is called.
+		/// Otherwise this is the same as the other call_service, deferred is false and done is not called.
+		bool call_service(unsigned saftbus_object_id, int client_fd, Deserializer &received, Serializer &send, 
+		                  const std::function<void(Serializer &reply)> &done, bool &deferred);
 		void remove_signal_fd(int fd);
 
+		/// @brief deliver all signals for signal_group_fd through a shared memory ring instead of the socket.
+		///
+		/// The ring is created by a client side SignalGroup (see saftbus::SignalRing). It is removed together
+		/// with the signal_group_fd when the client hangs up.
+		/// @param signal_group_fd the signal socket of the SignalGroup that created the ring
+		/// @param memfd the shared memory of the ring (the Container takes ownership)
+		/// @param eventfd the wakeup eventfd of the ring (the Container takes ownership)
+		/// @return false if the ring could not be mapped. The file descriptors are closed in this case.
+		bool attach_signal_ring(int signal_group_fd, int memfd, int eventfd);
+
+		/// @brief restrict the signals that a Service object sends to signal_group_fd.
+		///
+		/// Called by client side Proxy objects (see saftbus::Proxy::ignore_unconnected_signals). 
+		/// The filter is removed when another Proxy registers for the same Service object and signal_group_fd.
+		/// @param saftbus_object_id identifies the service object
+		/// @param signal_group_fd the signal socket of the SignalGroup
+		/// @param filter if false, all signals are sent
+		/// @param interface_nos together with signal_nos: the signals that are sent if filter is true
+		void set_signal_filter(unsigned saftbus_object_id, int signal_group_fd, bool filter, const std::vector<int> &interface_nos, const std::vector<int> &signal_nos);
+
 		/// @brief iterate all owned services and remove the ones previously owned by client with this fd
 		/// @param fd the file descriptor that signaled a hung-up condition
 		void client_hung_up(int fd);
@@ -214,6 +253,9 @@ namespace saftbus {
 		// return saftbus_object_id if the object_path was found and all requested interfaces are implemented
 		// return 0 if object_path was not found
 		// return -1 if object_path was found but not all requested interfaces are implemented by the object
+		// same return values as register_proxy, but the Proxy is not registered for signals.
+		// Used by call-only Proxies (see saftbus::SignalGroup::none)
+		int lookup_object(const std::string &object_path, const std::vector<std::string> &interface_names, std::map<std::string,int> &interface_name2no_map);
 		// @saftbus-export 
 		int register_proxy(const std::string &object_path, const std::vector<std::string> interface_names, std::map<std::string,int> &interface_name2no_map, int client_fd, int signal_group_fd);
 		// @saftbus-export
@@ -0,0 +1,236 @@
+/** Copyright (C) 2021-2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  @author Michael Reese <m.reese@gsi.de>
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#include "signal_queue.hpp"
+#include "saftbus.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
+
+namespace saftbus {
+
+	// Serializer::write_to sends the length and the first chunk of the payload in one record,
+	// the rest of the payload in records of at most this size.
+	static const size_t max_record_size = 100000;
+
+	static size_t max_bytes_from_env() {
+		const char *size_env = getenv("SAFTBUS_SIGNAL_QUEUE_SIZE");
+		if (size_env == nullptr) {
+			return 1048576;
+		}
+		return strtoul(size_env, nullptr, 0);
+	}
+
+	static SignalQueue::Policy policy_from_env() {
+		const char *policy_env = getenv("SAFTBUS_SIGNAL_QUEUE_POLICY");
+		if (policy_env != nullptr) {
+			std::string policy(policy_env);
+			if (policy == "drop-oldest") return SignalQueue::Policy::DropOldest;
+			if (policy == "block")       return SignalQueue::Policy::Block;
+		}
+		return SignalQueue::Policy::DropNewest;
+	}
+
+	SignalQueue::SignalQueue(int f, Loop &l)
+		: SignalQueue(f, l, max_bytes_from_env(), policy_from_env())
+	{
+	}
+
+	SignalQueue::SignalQueue(int f, Loop &l, size_t max, Policy p)
+		: fd(f), loop(l), max_bytes(max), policy(p), queued_bytes(0), dropped(0), broken(false)
+	{
+	}
+
+	SignalQueue::~SignalQueue()
+	{
+		loop.remove(io_source);
+	}
+
+	void SignalQueue::push(Serializer &signal)
+	{
+		if (broken) {
+			++dropped;
+			return;
+		}
+		int size = signal._data.size();
+		int first_chunk = std::min(size, Deserializer::first_chunk_size);
+		size_t offset = 0;
+		if (messages.empty() || flush()) {
+			// nothing is queued: write directly from the serializer, like Serializer::write_to_no_init
+			struct iovec iov[2];
+			iov[0].iov_base = &size;
+			iov[0].iov_len  = sizeof(size);
+			iov[1].iov_base = &signal._data[0];
+			iov[1].iov_len  = first_chunk;
+			struct msghdr msg = {};
+			msg.msg_iov    = iov;
+			msg.msg_iovlen = 2;
+			int result = sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+			if (result == (int)sizeof(size)+first_chunk) {
+				offset = result;
+				while (offset < sizeof(size)+size) {
+					size_t record = std::min(sizeof(size)+size-offset, max_record_size);
+					result = send(fd, &signal._data[offset-sizeof(size)], record, MSG_DONTWAIT | MSG_NOSIGNAL);
+					if (result != (int)record) {
+						break;
+					}
+					offset += record;
+				}
+				if (offset == sizeof(size)+size) {
+					return; // everything was sent
+				}
+			}
+			if (result == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+				broken = true;
+				++dropped;
+				return;
+			}
+		}
+		size_t unsent = sizeof(size)+size-offset;
+		// a message that was partially sent must be completed, otherwise the client would see garbage
+		if (offset == 0 && queued_bytes + unsent > max_bytes && !make_room(unsent)) {
+			++dropped;
+			return;
+		}
+		messages.push_back(Message());
+		Message &message = messages.back();
+		message.data.resize(sizeof(size)+size);
+		memcpy(&message.data[0],            &size,            sizeof(size));
+		memcpy(&message.data[sizeof(size)], &signal._data[0], size);
+		message.offset = offset;
+		queued_bytes += unsent;
+		watch_fd();
+	}
+
+	uint64_t SignalQueue::get_dropped() const
+	{
+		return dropped;
+	}
+
+	size_t SignalQueue::get_queued_bytes() const
+	{
+		return queued_bytes;
+	}
+
+	// send queued records until the socket is full, return true if the queue is empty
+	bool SignalQueue::flush()
+	{
+		while (!messages.empty()) {
+			if (!send_record(messages.front())) {
+				return false;
+			}
+			if (messages.front().offset == messages.front().data.size()) {
+				messages.pop_front();
+			}
+		}
+		return true;
+	}
+
+	bool SignalQueue::send_record(Message &message)
+	{
+		int size;
+		memcpy(&size, &message.data[0], sizeof(size));
+		size_t first_record = sizeof(size) + std::min(size, Deserializer::first_chunk_size);
+		size_t record;
+		if (message.offset < first_record) {
+			record = first_record;
+		} else {
+			record = std::min(message.data.size() - message.offset, max_record_size);
+		}
+		int result = send(fd, &message.data[message.offset], record, MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (result == (int)record) {
+			message.offset += record;
+			queued_bytes   -= record;
+			return true;
+		}
+		if (result == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+			// the client is gone, Container will remove this queue when it notices
+			broken = true;
+			dropped += messages.size();
+			messages.clear();
+			queued_bytes = 0;
+		}
+		return false;
+	}
+
+	// try to make room for size bytes according to the policy
+	bool SignalQueue::make_room(size_t size)
+	{
+		switch (policy) {
+			case Policy::DropOldest: {
+				// the first message may be partially sent already and has to stay
+				size_t keep = (!messages.empty() && messages.front().offset > 0) ? 1 : 0;
+				while (queued_bytes + size > max_bytes && messages.size() > keep) {
+					queued_bytes -= messages[keep].data.size();
+					messages.erase(messages.begin()+keep);
+					++dropped;
+				}
+			} break;
+			case Policy::Block: {
+				auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+				while (queued_bytes + size > max_bytes && !broken) {
+					int timeout_ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+					struct pollfd pfd;
+					pfd.fd = fd;
+					pfd.events = POLLOUT;
+					if (timeout_ms < 0 || poll(&pfd, 1, timeout_ms) <= 0) {
+						break;
+					}
+					flush();
+				}
+			} break;
+			case Policy::DropNewest:
+			break;
+		}
+		return queued_bytes + size <= max_bytes;
+	}
+
+	void SignalQueue::watch_fd()
+	{
+		if (!io_source.connected()) {
+			io_source = loop.connect<IoSource>(std::bind(&SignalQueue::fd_writable, this, std::placeholders::_1, std::placeholders::_2), fd, POLLOUT);
+		}
+	}
+
+	bool SignalQueue::fd_writable(int, int condition)
+	{
+		if (condition & (POLLHUP | POLLERR)) {
+			broken = true;
+			dropped += messages.size();
+			messages.clear();
+			queued_bytes = 0;
+		} else {
+			flush();
+		}
+		if (messages.empty()) {
+			io_source = SourceHandle(); // returning false removes the source from the loop
+			return false;
+		}
+		return true;
+	}
+
+}
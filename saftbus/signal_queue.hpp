@@ -0,0 +1,85 @@
+/** Copyright (C) 2021-2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  @author Michael Reese <m.reese@gsi.de>
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#ifndef SAFTBUS_SIGNAL_QUEUE_HPP_
+#define SAFTBUS_SIGNAL_QUEUE_HPP_
+
+#include "loop.hpp"
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace saftbus {
+
+	class Serializer;
+
+	/// @brief Bounded outbound queue for the signals going to one signal fd (i.e. one client side SignalGroup).
+	///
+	/// Signals are written without blocking. If the socket is full, the signal is copied into the queue
+	/// and an IoSource in the Loop sends it as soon as the socket becomes writable again. Signals
+	/// keep their order and the message framing of Serializer::write_to.
+	/// If the queue is full, the Policy decides what happens to a new signal.
+	class SignalQueue {
+	public:
+		enum class Policy {
+			DropNewest, ///< drop the signal that doesn't fit (default)
+			DropOldest, ///< drop queued signals that were not started yet, to make room for the new one
+			Block,      ///< wait up to 10 ms for the client to make room (backpressure), drop the signal if that doesn't help
+		};
+		/// @brief queue size and policy from the environment variables SAFTBUS_SIGNAL_QUEUE_SIZE and SAFTBUS_SIGNAL_QUEUE_POLICY
+		SignalQueue(int fd, Loop &loop);
+		SignalQueue(int fd, Loop &loop, size_t max_bytes, Policy policy);
+		~SignalQueue();
+
+		/// @brief send the signal now or queue it. Doesn't block unless the policy is Block.
+		void push(Serializer &signal);
+
+		/// @brief number of signals that were dropped because the queue was full
+		uint64_t get_dropped() const;
+		/// @brief number of bytes currently waiting to be sent
+		size_t get_queued_bytes() const;
+
+	private:
+		struct Message {
+			std::vector<char> data; // length + payload
+			size_t offset;          // number of bytes already sent, always at a record boundary
+		};
+		bool flush();
+		bool send_record(Message &message);
+		bool make_room(size_t size);
+		void watch_fd();
+		bool fd_writable(int fd, int condition);
+
+		int fd;
+		Loop &loop;
+		size_t max_bytes;
+		Policy policy;
+		std::deque<Message> messages;
+		size_t queued_bytes;
+		uint64_t dropped;
+		bool broken;          // fd reported an error, nothing will be sent anymore
+		SourceHandle io_source;
+	};
+
+}
+
+#endif
@@ -0,0 +1,225 @@
+/** Copyright (C) 2021-2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  @author Michael Reese <m.reese@gsi.de>
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#include "signal_ring.hpp"
+#include "saftbus.hpp"
+
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace saftbus {
+
+	// The header is shared between the two processes. head is only written by the
+	// producer, tail only by the consumer. Both are free running byte counters.
+	struct SignalRing::Header {
+		alignas(64) std::atomic<uint64_t> head;
+		alignas(64) std::atomic<uint64_t> tail;
+		alignas(64) std::atomic<uint32_t> parked;
+		uint32_t capacity;
+	};
+
+	static size_t record_size(size_t payload_size) {
+		return (sizeof(uint32_t) + payload_size + 7) & ~size_t(7);
+	}
+
+	SignalRing::SignalRing(size_t cap)
+		: header(nullptr), data(nullptr), capacity(4096), mapped_size(0), local_head(0), dropped(0), memfd(-1), eventfd(-1)
+	{
+		while (capacity < cap) capacity <<= 1;
+		mapped_size = sizeof(Header) + capacity;
+		memfd = memfd_create("saftbus-signal-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+		if (memfd == -1) {
+			return;
+		}
+		// saftbusd only accepts rings with a fixed size (see the other constructor)
+		if (ftruncate(memfd, mapped_size) != 0 || fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) {
+			close(memfd); memfd = -1;
+			return;
+		}
+		void *mem = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+		if (mem == MAP_FAILED) {
+			close(memfd); memfd = -1;
+			return;
+		}
+		eventfd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (eventfd == -1) {
+			munmap(mem, mapped_size);
+			close(memfd); memfd = -1;
+			return;
+		}
+		header = new(mem) Header;
+		header->head     = 0;
+		header->tail     = 0;
+		header->parked   = 1; // the consumer is not draining until it was woken up the first time
+		header->capacity = capacity;
+		data = reinterpret_cast<char*>(mem) + sizeof(Header);
+	}
+
+	SignalRing::SignalRing(int mfd, int efd)
+		: header(nullptr), data(nullptr), capacity(0), mapped_size(0), local_head(0), dropped(0), memfd(mfd), eventfd(efd)
+	{
+		// The other side of the ring belongs to a client process. Don't trust anything
+		// in the shared memory that could make us write outside of the mapped area.
+		// Without the seals, the client could truncate the memfd and accessing the mapping would raise SIGBUS.
+		if (memfd == -1 || eventfd == -1) {
+			return;
+		}
+		int seals = fcntl(memfd, F_GET_SEALS);
+		if (seals == -1 || (seals & (F_SEAL_SHRINK | F_SEAL_GROW)) != (F_SEAL_SHRINK | F_SEAL_GROW)) {
+			return;
+		}
+		struct stat st;
+		if (fstat(memfd, &st) != 0 || st.st_size <= (off_t)sizeof(Header)) {
+			return;
+		}
+		size_t size = st.st_size;
+		void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+		if (mem == MAP_FAILED) {
+			return;
+		}
+		Header *h = reinterpret_cast<Header*>(mem);
+		size_t cap = h->capacity;
+		if (cap == 0 || (cap & (cap-1)) != 0 || sizeof(Header) + cap != size) {
+			munmap(mem, size);
+			return;
+		}
+		header      = h;
+		data        = reinterpret_cast<char*>(mem) + sizeof(Header);
+		capacity    = cap;
+		mapped_size = size;
+		local_head  = header->head.load();
+	}
+
+	SignalRing::~SignalRing()
+	{
+		if (header) {
+			munmap(header, mapped_size);
+		}
+		if (memfd != -1) {
+			close(memfd);
+		}
+		if (eventfd != -1) {
+			close(eventfd);
+		}
+	}
+
+	bool SignalRing::valid() const
+	{
+		return header != nullptr;
+	}
+
+	bool SignalRing::push(Serializer &serializer)
+	{
+		uint32_t size = serializer._data.size();
+		size_t   rec  = record_size(size);
+		if (rec > capacity) {
+			return false;
+		}
+		uint64_t tail = header->tail.load(std::memory_order_acquire);
+		uint64_t used = local_head - tail;
+		if (used > capacity || capacity - used < rec) {
+			// ring is full (or the consumer corrupted the tail): drop the signal
+			++dropped;
+			return true;
+		}
+		size_t mask = capacity-1;
+		size_t pos  = local_head & mask;
+		// records are 8-byte aligned, the length can never wrap around the end of the ring
+		memcpy(data + pos, &size, sizeof(size));
+		pos = (pos + sizeof(size)) & mask;
+		size_t first = std::min<size_t>(size, capacity-pos);
+		memcpy(data + pos, serializer._data.data(),       first);
+		memcpy(data,       serializer._data.data()+first, size-first);
+		local_head += rec;
+		header->head.store(local_head, std::memory_order_seq_cst);
+		if (header->parked.load(std::memory_order_seq_cst)) {
+			uint64_t one = 1;
+			if (write(eventfd, &one, sizeof(one)) != sizeof(one)) {
+				// the eventfd counter can only overflow if the consumer never reads it, nothing to do
+			}
+		}
+		return true;
+	}
+
+	bool SignalRing::pop(Deserializer &deserializer)
+	{
+		uint64_t tail = header->tail.load(std::memory_order_relaxed);
+		uint64_t head = header->head.load(std::memory_order_acquire);
+		if (head == tail) {
+			return false;
+		}
+		size_t mask = capacity-1;
+		size_t pos  = tail & mask;
+		uint32_t size;
+		memcpy(&size, data + pos, sizeof(size));
+		pos = (pos + sizeof(size)) & mask;
+		deserializer._data.resize(size);
+		size_t first = std::min<size_t>(size, capacity-pos);
+		memcpy(deserializer._data.data(),       data + pos, first);
+		memcpy(deserializer._data.data()+first, data,       size-first);
+		header->tail.store(tail + record_size(size), std::memory_order_release);
+		deserializer.get_init();
+		return true;
+	}
+
+	bool SignalRing::park()
+	{
+		header->parked.store(1, std::memory_order_seq_cst);
+		return header->head.load(std::memory_order_seq_cst) == header->tail.load(std::memory_order_relaxed);
+	}
+
+	void SignalRing::unpark()
+	{
+		uint64_t count;
+		if (read(eventfd, &count, sizeof(count)) != sizeof(count)) {
+			// EAGAIN: the eventfd was not signaled, nothing to clear
+		}
+		header->parked.store(0, std::memory_order_seq_cst);
+	}
+
+	void SignalRing::notify()
+	{
+		uint64_t one = 1;
+		if (write(eventfd, &one, sizeof(one)) != sizeof(one)) {
+		}
+	}
+
+	int SignalRing::get_memfd() const
+	{
+		return memfd;
+	}
+	int SignalRing::get_eventfd() const
+	{
+		return eventfd;
+	}
+	uint64_t SignalRing::get_dropped() const
+	{
+		return dropped;
+	}
+
+}
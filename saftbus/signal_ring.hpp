@@ -0,0 +1,96 @@
+/** Copyright (C) 2021-2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  @author Michael Reese <m.reese@gsi.de>
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#ifndef SAFTBUS_SIGNAL_RING_HPP_
+#define SAFTBUS_SIGNAL_RING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace saftbus {
+
+	class Serializer;
+	class Deserializer;
+
+	/// @brief Single-producer/single-consumer ring buffer in shared memory to transport signals.
+	///
+	/// The consumer side (a SignalGroup in the client process) creates the ring in a memfd and
+	/// creates an eventfd for wakeups. Both file descriptors are sent to the server with sendfd().
+	/// The producer side (the Container in the server process) maps the same memory and pushes
+	/// serialized signals into it.
+	///
+	/// The eventfd is only written by the producer if the consumer has declared itself as parked
+	/// (i.e. it is about to wait or has returned to an external event loop). While the consumer
+	/// is draining the ring, signals are transferred without any system call.
+	///
+	/// Each message in the ring is stored as a 32-bit length followed by the payload, padded to 8 bytes.
+	class SignalRing {
+	public:
+		/// @brief Consumer side: create a new ring in a memfd and an eventfd for wakeups
+		/// @param capacity size of the data area in bytes, rounded up to the next power of 2.
+		SignalRing(size_t capacity);
+		/// @brief Producer side: map a ring that was created by the consumer
+		/// @param memfd file descriptor of the shared memory (the ring takes ownership)
+		/// @param eventfd file descriptor of the wakeup eventfd (the ring takes ownership)
+		SignalRing(int memfd, int eventfd);
+		~SignalRing();
+
+		/// @brief false if the ring could not be created or mapped.
+		bool valid() const;
+
+		/// @brief Producer: copy the content of the serializer into the ring and wake up the consumer if it is parked.
+		///
+		/// If the ring is full, the message is dropped (and counted) just like a signal that cannot be 
+		/// written to a congested socket.
+		/// @return false if the message is larger than the ring. It has to be sent over the socket in that case.
+		bool push(Serializer &serializer);
+
+		/// @brief Consumer: copy the next message from the ring into the deserializer.
+		/// @return false if the ring is empty.
+		bool pop(Deserializer &deserializer);
+		/// @brief Consumer: declare that no more messages will be consumed without waiting on the eventfd first.
+		/// @return true if the ring is still empty after parking (it is save to wait on the eventfd).
+		bool park();
+		/// @brief Consumer: called after waking up on the eventfd. Clears the eventfd and the parked flag.
+		void unpark();
+		/// @brief Consumer: signal the eventfd, e.g. to make an external event loop come back for pending messages.
+		void notify();
+
+		int get_memfd() const;
+		int get_eventfd() const;
+
+		/// @brief number of messages that were dropped by the producer because the ring was full.
+		uint64_t get_dropped() const;
+
+	private:
+		struct Header;
+		Header *header;
+		char   *data;
+		size_t  capacity;
+		size_t  mapped_size;
+		uint64_t local_head; // producer keeps its own copy, the shared one is only published
+		uint64_t dropped;
+		int memfd;
+		int eventfd;
+	};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  @author Michael Reese <m.reese@gsi.de>
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#ifndef SAFTLIB_ACTION_RECORD_HPP_
+#define SAFTLIB_ACTION_RECORD_HPP_
+
+#include <cstdint>
+
+namespace saftlib {
+
+	/// @brief One action as delivered by the SoftwareCondition::SigActions signal.
+	///
+	/// This is a POD type without implicit padding, a std::vector of ActionRecords
+	/// is serialized by saftbus with a single memcpy.
+	/// deadline and executed are TAI timestamps in nanoseconds,
+	/// use saftlib::makeTimeTAI to convert them into saftlib::Time.
+	struct ActionRecord {
+		uint64_t event;    ///< The event identifier that matched the condition
+		uint64_t param;    ///< The parameter field, whose meaning depends on the event ID
+		uint64_t deadline; ///< The scheduled execution time of the action (TAI)
+		uint64_t executed; ///< The actual execution time of the action (TAI)
+		uint16_t flags;    ///< Whether the action was (ok=0,late=1,early=2,conflict=4,delayed=8)
+		uint16_t reserved16;
+		uint32_t reserved32;
+	};
+
+}
+
+#endif
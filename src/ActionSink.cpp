@@ -49,6 +49,7 @@ ActionSink::ActionSink(ECA &eca_
 	eca(eca_), name(name_), channel(channel_), num(num_),
 	minOffset(-1000000000L),  maxOffset(1000000000L), signalRate(std::chrono::nanoseconds(100000000L)),
 	overflowCount(0), actionCount(0), lateCount(0), earlyCount(0), conflictCount(0), delayedCount(0),
+	conditionBatches(0),
 	container(container_)
 {
 
@@ -86,12 +87,12 @@ ActionSink::~ActionSink()
 {
 	// std::cerr << "~ActionSink " << getObjectPath() << std::endl;
 	// unhook any pending updates
-	saftbus::Loop::get_default().remove(overflowPending);
-	saftbus::Loop::get_default().remove(actionPending);
-	saftbus::Loop::get_default().remove(latePending);
-	saftbus::Loop::get_default().remove(earlyPending);
-	saftbus::Loop::get_default().remove(conflictPending);
-	saftbus::Loop::get_default().remove(delayedPending);
+	eca.cancelCounterRefreshes(this);
+	saftbus::Loop::get_default().remove(batchPending);
+	if (conditionBatches > 0) {
+		// No need to recompile; the sink is removed anyway and whoever removes it recompiles
+		eca.resumeCompile(false);
+	}
 
 	if (container) {
 		while (conditions.size()) {
@@ -128,6 +129,69 @@ void ActionSink::ToggleActive()
 	}
 }
 
+void ActionSink::BeginConditionBatch()
+{
+	ownerOnly();
+	if (conditionBatches++ == 0) {
+		batchValues.clear();
+		for (auto &number_condition: conditions) {
+			batchValues[number_condition.first] = number_condition.second->getRawValues();
+		}
+		eca.deferCompile();
+		batchPending = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
+			std::bind(&ActionSink::commitForgottenBatch, this), std::chrono::milliseconds(1000));
+	}
+}
+
+void ActionSink::CommitConditionBatch()
+{
+	ownerOnly();
+	if (conditionBatches == 0) {
+		throw saftbus::Error(saftbus::Error::INVALID_ARGS, "CommitConditionBatch without BeginConditionBatch");
+	}
+	if (--conditionBatches == 0) {
+		saftbus::Loop::get_default().remove(batchPending);
+		commitBatch();
+	}
+}
+
+void ActionSink::commitBatch()
+{
+	try {
+		eca.resumeCompile();
+	} catch (...) {
+		// failed => restore the conditions from BeginConditionBatch
+		for (auto &number_condition: conditions) {
+			auto values = batchValues.find(number_condition.first);
+			if (values != batchValues.end()) {
+				number_condition.second->setRawValues(values->second);
+			} else {
+				number_condition.second->setRawActive(false);
+			}
+		}
+		batchValues.clear();
+		try {
+			eca.compile();
+		} catch (saftbus::Error &e) {
+			std::cerr << "ActionSink " << getObjectPath() << ": failed to restore the conditions after a failed batch: " << e.what() << std::endl;
+		}
+		throw;
+	}
+	batchValues.clear();
+}
+
+bool ActionSink::commitForgottenBatch()
+{
+	std::cerr << "ActionSink " << getObjectPath() << ": condition batch was not committed within one second, commit it now" << std::endl;
+	conditionBatches = 0;
+	try {
+		commitBatch();
+	} catch (saftbus::Error &e) {
+		std::cerr << "ActionSink " << getObjectPath() << ": commit failed: " << e.what() << std::endl;
+	}
+	return false; // one-shot
+}
+
 uint16_t ActionSink::ReadFill()
 {
 	return eca.updateMostFull(channel);
@@ -304,58 +368,32 @@ void ActionSink::setDelayedCount(uint64_t val)
 void ActionSink::receiveMSI(uint8_t code)
 {
 	// std::cerr << "ActionSink::receiveMSI(" << code << ")" << std::endl;
-	std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
-	std::chrono::steady_clock::time_point exec; 
-	std::chrono::milliseconds interval(0);
-
+	// The counters are read by the ECA, together with the pending counters of all other sinks.
+	// SignalRate imposes a minimum delay since the last update of the counter.
 	switch (code) {
 	case ECA_OVERFLOW:
 		//DRIVER_LOG("ECA_OVERFLOW",-1, -1);
-		saftbus::Loop::get_default().remove(overflowPending); // just to be safe
-		exec = overflowUpdate + signalRate;
-		if (exec > time) interval = std::chrono::duration_cast<std::chrono::milliseconds>(exec-time);
-		overflowPending = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
-			std::bind(&ActionSink::updateOverflow, this),interval,interval);
+		eca.requestCounterRefresh(this, code, overflowUpdate + signalRate);
 		break;
 	case ECA_VALID:
 		//DRIVER_LOG("ECA_VALID",-1, -1);
-		saftbus::Loop::get_default().remove(actionPending); // just to be safe
-		exec = actionUpdate + signalRate;
-		if (exec > time) interval = std::chrono::duration_cast<std::chrono::milliseconds>(exec-time);
-		actionPending = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
-			std::bind(&ActionSink::updateAction, this),interval,interval);
+		eca.requestCounterRefresh(this, code, actionUpdate + signalRate);
 		break;
 	case ECA_LATE:
 		//DRIVER_LOG("ECA_LATE",-1, -1);
-		saftbus::Loop::get_default().remove(latePending); // just to be safe
-		exec = lateUpdate + signalRate;
-		if (exec > time) interval = std::chrono::duration_cast<std::chrono::milliseconds>(exec-time);
-		latePending = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
-			std::bind(&ActionSink::updateLate, this),interval,interval);
+		eca.requestCounterRefresh(this, code, lateUpdate + signalRate);
 		break;
 	case ECA_EARLY:
 		//DRIVER_LOG("ECA_EARLY",-1, -1);
-		saftbus::Loop::get_default().remove(earlyPending); // just to be safe
-		exec = earlyUpdate + signalRate;
-		if (exec > time) interval = std::chrono::duration_cast<std::chrono::milliseconds>(exec-time);
-		earlyPending = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
-			std::bind(&ActionSink::updateEarly, this),interval,interval);
+		eca.requestCounterRefresh(this, code, earlyUpdate + signalRate);
 		break;
 	case ECA_CONFLICT:
 		//DRIVER_LOG("ECA_CONFLICT",-1, -1);
-		saftbus::Loop::get_default().remove(conflictPending); // just to be safe
-		exec = conflictUpdate + signalRate;
-		if (exec > time) interval = std::chrono::duration_cast<std::chrono::milliseconds>(exec-time);
-		conflictPending = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
-			std::bind(&ActionSink::updateConflict, this),interval,interval);
+		eca.requestCounterRefresh(this, code, conflictUpdate + signalRate);
 		break;
 	case ECA_DELAYED:
 		//DRIVER_LOG("ECA_DELAYED",-1, -1);
-		saftbus::Loop::get_default().remove(delayedPending); // just to be safe
-		exec = delayedUpdate + signalRate;
-		if (exec > time) interval = std::chrono::duration_cast<std::chrono::milliseconds>(exec-time);
-		delayedPending = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
-			std::bind(&ActionSink::updateDelayed, this),interval,interval);
+		eca.requestCounterRefresh(this, code, delayedUpdate + signalRate);
 		break;
 	default:
 		//clog << kLogErr << "Asked to handle an invalid MSI condition code in ActionSink.cpp" << std::endl;
@@ -363,6 +401,43 @@ void ActionSink::receiveMSI(uint8_t code)
 	}
 }
 
+void ActionSink::addCount(uint8_t code, uint64_t count) const
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	switch (code) {
+	case ECA_OVERFLOW:
+		overflowCount += count;
+		OverflowCount(overflowCount);
+		overflowUpdate = now;
+		break;
+	case ECA_VALID:
+		actionCount += count;
+		ActionCount(actionCount);
+		actionUpdate = now;
+		break;
+	case ECA_LATE:
+		lateCount += count;
+		LateCount(lateCount);
+		lateUpdate = now;
+		break;
+	case ECA_EARLY:
+		earlyCount += count;
+		EarlyCount(earlyCount);
+		earlyUpdate = now;
+		break;
+	case ECA_CONFLICT:
+		conflictCount += count;
+		ConflictCount(conflictCount);
+		conflictUpdate = now;
+		break;
+	case ECA_DELAYED:
+		delayedCount += count;
+		DelayedCount(delayedCount);
+		delayedUpdate = now;
+		break;
+	}
+}
+
 bool ActionSink::updateOverflow() const
 {
 	//DRIVER_LOG("start",-1,-1);
@@ -376,10 +451,7 @@ bool ActionSink::updateOverflow() const
 	cycle.read (eca.get_base_address() + ECA_CHANNEL_OVERFLOW_COUNT_GET, EB_DATA32, &overflow);
 	cycle.close();
 
-	overflowCount += overflow;
-	OverflowCount(overflowCount);
-
-	overflowUpdate = std::chrono::steady_clock::now();
+	addCount(ECA_OVERFLOW, overflow);
 	
 	//DRIVER_LOG("done",-1, -1);
 	return false;
@@ -399,10 +471,7 @@ bool ActionSink::updateAction() const
 	cycle.read (eca.get_base_address() + ECA_CHANNEL_VALID_COUNT_GET, EB_DATA32, &valid);
 	cycle.close();
 
-	actionCount += valid;
-	ActionCount(actionCount);
-
-	actionUpdate = std::chrono::steady_clock::now();
+	addCount(ECA_VALID, valid);
 	//DRIVER_LOG("done",-1,channel);
 	return false;
 }
@@ -447,10 +516,7 @@ bool ActionSink::updateLate() const
 {
 	//DRIVER_LOG("start",-1, -1);
 	Record r = fetchError(ECA_LATE);
-	lateCount += r.count;
-	LateCount(lateCount);
-
-	lateUpdate = std::chrono::steady_clock::now();
+	addCount(ECA_LATE, r.count);
 	//DRIVER_LOG("done",-1, -1);
 	return false;
 }
@@ -459,10 +525,7 @@ bool ActionSink::updateEarly() const
 {
 	//DRIVER_LOG("start",-1, -1);
 	Record r = fetchError(ECA_EARLY);
-	earlyCount += r.count;
-	EarlyCount(earlyCount);
-
-	earlyUpdate = std::chrono::steady_clock::now();
+	addCount(ECA_EARLY, r.count);
 	//DRIVER_LOG("done",-1, -1);
 	return false;
 }
@@ -471,10 +534,7 @@ bool ActionSink::updateConflict() const
 {
 	//DRIVER_LOG("start",-1, -1);
 	Record r = fetchError(ECA_CONFLICT);
-	conflictCount += r.count;
-	ConflictCount(conflictCount);
-
-	conflictUpdate = std::chrono::steady_clock::now();
+	addCount(ECA_CONFLICT, r.count);
 	//DRIVER_LOG("done",-1, -1);
 	return false;
 }
@@ -483,10 +543,7 @@ bool ActionSink::updateDelayed() const
 {
 	//DRIVER_LOG("start",-1, -1);
 	Record r = fetchError(ECA_DELAYED);
-	delayedCount += r.count;
-	DelayedCount(delayedCount);
-
-	delayedUpdate = std::chrono::steady_clock::now();
+	addCount(ECA_DELAYED, r.count);
 	//DRIVER_LOG("done",-1, -1);
 	return false;
 }
@@ -557,7 +614,8 @@ Condition *ActionSink::getCondition(const std::string object_path) {
 unsigned ActionSink::createConditionNumber() {
 	for(;;) {
 		unsigned number = rand();
-		if (conditions.find(number) == conditions.end()) {
+		// numbers of conditions destroyed in a batch are not reused before the batch is committed
+		if (conditions.find(number) == conditions.end() && batchValues.find(number) == batchValues.end()) {
 			return number;
 		}
 	}
@@ -154,6 +154,30 @@ class ActionSink : public Owned
 		// @saftbus-export
 		void ToggleActive();
 
+		/// @brief Start a batch of condition changes.
+		///
+		/// Every change of an active condition (NewCondition, setID, setAcceptLate, Destroy, ...)
+		/// recompiles the ECA tables. Between BeginConditionBatch and CommitConditionBatch, 
+		/// the changes are only collected and CommitConditionBatch applies all of them with a 
+		/// single recompile. The hardware switches from the old set of conditions to the new 
+		/// set on one nanosecond, like with ToggleActive.
+		/// Errors (e.g. too many active conditions) are reported by CommitConditionBatch, 
+		/// the conditions of this ActionSink are restored to their values from BeginConditionBatch then
+		/// (conditions created in the batch are deactivated). 
+		/// Batches can be nested. While a batch is open, changes on other ActionSinks of the 
+		/// same TimingReceiver are also delayed until the commit, so keep batches short. 
+		/// A batch that is not committed within one second is committed automatically.
+		///
+		// @saftbus-export
+		void BeginConditionBatch();
+
+		/// @brief Apply all condition changes since BeginConditionBatch.
+		///
+		/// Throws if the new set of conditions cannot be compiled into the ECA tables.
+		///
+		// @saftbus-export
+		void CommitConditionBatch();
+
 		/// @brief Report the number of currently pending actions.
 		/// @return Number of pending actions.
 		///
@@ -276,7 +300,9 @@ class ActionSink : public Owned
 		/// The properties OverflowCount, ActionCount, LateCount, EarlyCount,
 		/// ConflictCount, and DelayedCount can increase rapidly. To prevent
 		/// excessive CPU load, SignalRate imposes a minimum cooldown between
-		/// updates to these values.
+		/// updates to these values. The pending updates of all ActionSinks
+		/// of one ECA are read together, at most once per
+		/// SAFTLIB_ECA_COUNTER_REFRESH_PERIOD milliseconds (default 10).
 		///
 		// @saftbus-export
 		uint64_t getSignalRate() const;
@@ -537,13 +563,12 @@ class ActionSink : public Owned
 		uint64_t earlyThreshold;
 		uint16_t capacity;
 		
-		// pending timeouts to refresh counters
-		saftbus::SourceHandle overflowPending;
-		saftbus::SourceHandle actionPending;
-		saftbus::SourceHandle latePending;
-		saftbus::SourceHandle earlyPending;
-		saftbus::SourceHandle conflictPending;
-		saftbus::SourceHandle delayedPending;
+		// open condition batches and the timeout that commits them if the client doesn't
+		unsigned conditionBatches;
+		saftbus::SourceHandle batchPending;
+		std::map<unsigned, Condition::Values> batchValues; // condition values from BeginConditionBatch
+		void commitBatch();
+		bool commitForgottenBatch();
 		
 		struct Record {
 			uint64_t event;
@@ -554,6 +579,10 @@ class ActionSink : public Owned
 		};
 		Record fetchError(uint8_t code) const;
 		
+		// add to a counter and announce the new value, used by ECA::refreshCounters
+		void addCount(uint8_t code, uint64_t count) const;
+		friend class ECA;
+
 		bool updateOverflow() const;
 		bool updateAction() const;
 		bool updateLate() const;
@@ -130,6 +130,20 @@ class Condition  : public Owned
     // used by TimingReceiver and ActionSink
     uint32_t getRawTag() const { return tag; }
     void setRawActive(bool val) { active = val; }
+
+    // used by ActionSink to restore the conditions if a condition batch fails
+    struct Values {
+      uint64_t id, mask;
+      int64_t offset;
+      bool acceptLate, acceptEarly, acceptConflict, acceptDelayed;
+      bool active;
+    };
+    Values getRawValues() const { return Values{id, mask, offset, acceptLate, acceptEarly, acceptConflict, acceptDelayed, active}; }
+    void setRawValues(const Values &values) { 
+      id = values.id; mask = values.mask; offset = values.offset;
+      acceptLate = values.acceptLate; acceptEarly = values.acceptEarly; acceptConflict = values.acceptConflict; acceptDelayed = values.acceptDelayed;
+      active = values.active;
+    }
     
 
     unsigned getNumber() const { return number; } 
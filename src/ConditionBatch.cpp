@@ -0,0 +1,50 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  @author Michael Reese <m.reese@gsi.de>
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#include "ConditionBatch.hpp"
+
+namespace saftlib {
+
+	ConditionBatch::ConditionBatch(std::shared_ptr<ActionSink_Proxy> s)
+		: sink(s), committed(false)
+	{
+		sink->BeginConditionBatch();
+	}
+
+	ConditionBatch::~ConditionBatch()
+	{
+		if (!committed) {
+			try {
+				sink->CommitConditionBatch();
+			} catch (...) {
+				// destructors must not throw
+			}
+		}
+	}
+
+	void ConditionBatch::commit()
+	{
+		if (!committed) {
+			committed = true;
+			sink->CommitConditionBatch();
+		}
+	}
+
+}
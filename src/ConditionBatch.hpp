@@ -0,0 +1,54 @@
+/*  Copyright (C) 2022 GSI Helmholtz Centre for Heavy Ion Research GmbH
+ *
+ *  @author Michael Reese <m.reese@gsi.de>
+ *
+ *******************************************************************************
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************
+ */
+
+#ifndef saftlib_CONDITION_BATCH_HPP_
+#define saftlib_CONDITION_BATCH_HPP_
+
+#include "ActionSink_Proxy.hpp"
+
+#include <memory>
+
+namespace saftlib {
+
+	/// @brief Client side helper to change several conditions of an ActionSink with one recompile of the ECA tables.
+	///
+	/// The constructor calls ActionSink::BeginConditionBatch, commit() calls ActionSink::CommitConditionBatch.
+	/// If commit() was not called, the destructor does it (and ignores errors).
+	///
+	///     {
+	///         saftlib::ConditionBatch batch(sink);
+	///         auto condition = saftlib::SoftwareCondition_Proxy::create(sink->NewCondition(true, id, mask, offset));
+	///         condition->setAcceptLate(true);
+	///         condition->setAcceptEarly(true);
+	///         batch.commit(); // one recompile, errors are reported here
+	///     }
+	class ConditionBatch {
+	public:
+		ConditionBatch(std::shared_ptr<ActionSink_Proxy> sink);
+		~ConditionBatch();
+		void commit();
+	private:
+		std::shared_ptr<ActionSink_Proxy> sink;
+		bool committed;
+	};
+
+}
+
+#endif
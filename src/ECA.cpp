@@ -285,6 +285,91 @@ void ECA::msiHandler(eb_data_t msi, unsigned channel)
 	}
 }
 
+void ECA::requestCounterRefresh(ActionSink *sink, uint8_t code, std::chrono::steady_clock::time_point due)
+{
+	for (auto &refresh: counter_refreshes) {
+		if (refresh.sink == sink && refresh.code == code) {
+			return; // already pending, the counter is read completely anyway
+		}
+	}
+	CounterRefresh refresh = { sink, code, due };
+	counter_refreshes.push_back(refresh);
+	if (counter_refresh_timeout.connected() && due < counter_refresh_scheduled) {
+		// the pending refreshes of other sinks may have a slower SignalRate
+		saftbus::Loop::get_default().remove(counter_refresh_timeout);
+		counter_refresh_timeout = saftbus::SourceHandle();
+	}
+	scheduleCounterRefresh();
+}
+
+void ECA::cancelCounterRefreshes(ActionSink *sink)
+{
+	counter_refreshes.erase(std::remove_if(counter_refreshes.begin(), counter_refreshes.end(), 
+		[sink](const CounterRefresh &refresh) { return refresh.sink == sink; }), counter_refreshes.end());
+}
+
+void ECA::scheduleCounterRefresh()
+{
+	if (counter_refreshes.empty() || counter_refresh_timeout.connected()) {
+		return;
+	}
+	std::chrono::steady_clock::time_point exec = counter_refreshes.front().due;
+	for (auto &refresh: counter_refreshes) {
+		exec = std::min(exec, refresh.due);
+	}
+	exec = std::max(exec, counter_refresh_last + counter_refresh_period);
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::chrono::microseconds interval(0);
+	if (exec > now) interval = std::chrono::duration_cast<std::chrono::microseconds>(exec-now);
+	counter_refresh_scheduled = exec;
+	counter_refresh_timeout = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
+		std::bind(&ECA::refreshCounters, this), interval, interval);
+}
+
+bool ECA::refreshCounters()
+{
+	counter_refresh_timeout = saftbus::SourceHandle(); // returning false removes the source from the loop
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	// refreshes that are not due yet stay for the next cycle
+	auto not_due = std::stable_partition(counter_refreshes.begin(), counter_refreshes.end(), 
+		[now](const CounterRefresh &refresh) { return refresh.due <= now; });
+	std::vector<CounterRefresh> refreshes(counter_refreshes.begin(), not_due);
+	counter_refreshes.erase(counter_refreshes.begin(), not_due);
+
+	if (!refreshes.empty()) {
+		std::vector<eb_data_t> counts(refreshes.size());
+		etherbone::Cycle cycle;
+		cycle.open(device);
+		for (unsigned i = 0; i < refreshes.size(); ++i) {
+			cycle.write(adr_first + ECA_CHANNEL_SELECT_RW,     EB_DATA32, refreshes[i].sink->getChannel());
+			cycle.write(adr_first + ECA_CHANNEL_NUM_SELECT_RW, EB_DATA32, refreshes[i].sink->getNum());
+			// reading a count clears it and rearms the MSI
+			switch (refreshes[i].code) {
+				case ECA_OVERFLOW:
+					cycle.read(adr_first + ECA_CHANNEL_OVERFLOW_COUNT_GET, EB_DATA32, &counts[i]);
+				break;
+				case ECA_VALID:
+					cycle.read(adr_first + ECA_CHANNEL_VALID_COUNT_GET,    EB_DATA32, &counts[i]);
+				break;
+				default:
+					// also releases the failed action record
+					cycle.write(adr_first + ECA_CHANNEL_CODE_SELECT_RW,    EB_DATA32, refreshes[i].code);
+					cycle.read (adr_first + ECA_CHANNEL_FAILED_COUNT_GET,  EB_DATA32, &counts[i]);
+			}
+		}
+		cycle.close();
+		counter_refresh_last = now;
+
+		for (unsigned i = 0; i < refreshes.size(); ++i) {
+			refreshes[i].sink->addCount(refreshes[i].code, counts[i]);
+		}
+	}
+
+	scheduleCounterRefresh();
+	return false;
+}
+
 void ECA::setHandler(unsigned channel, bool enable, eb_address_t address)
 {
 	etherbone::Cycle cycle;
@@ -323,22 +408,6 @@ static bool operator < (const ECA_OpenClose& a, const ECA_OpenClose& b)
 	return false;
 }
 
-struct SearchEntry {
-	uint64_t event;
-	int16_t  index;
-	SearchEntry(uint64_t e, int16_t i) : event(e), index(i) { }
-};
-
-struct WalkEntry {
-	int16_t   next;
-	int64_t   offset;
-	uint32_t  tag;
-	uint8_t   flags;
-	unsigned channel;
-	unsigned num;
-	WalkEntry(int16_t n, const ECA_OpenClose& oc) : next(n), 
-	offset(oc.offset), tag(oc.tag), flags(oc.flags), channel(oc.channel), num(oc.num) { }
-};
 
 void ECA::ToggleActive()
 {
@@ -413,9 +482,28 @@ void ECA::InactivateAll() {
 	}
 }
 
+void ECA::deferCompile()
+{
+	++compile_deferrals;
+}
+
+void ECA::resumeCompile(bool recompile)
+{
+	assert(compile_deferrals > 0);
+	if (--compile_deferrals == 0 && compile_pending && recompile) {
+		compile();
+	}
+}
+
 void ECA::compile()
 {
 	// std::cerr << "ECA::compile" << std::endl;
+	if (compile_deferrals > 0) {
+		compile_pending = true;
+		return;
+	}
+	compile_pending = false;
+
 	// Store all active conditions into a vector for processing
 	typedef std::vector<ECA_OpenClose> ID_Space;
 	ID_Space id_space;
@@ -494,7 +582,14 @@ void ECA::compile()
 		
 		// push the opens
 		while (i < id_space.size() && cursor == id_space[i].key && id_space[i].open) {
-			walk.push_back(WalkEntry(next, id_space[i]));
+			WalkEntry we;
+			we.next    = next;
+			we.offset  = id_space[i].offset;
+			we.tag     = id_space[i].tag;
+			we.flags   = id_space[i].flags;
+			we.channel = id_space[i].channel;
+			we.num     = id_space[i].num;
+			walk.push_back(we);
 			next = walk.size()-1;
 			++i;
 		}
@@ -510,24 +605,60 @@ void ECA::compile()
 // 		clog << kLogDebug << "W: " << walk[i].next << " " << walk[i].offset << " " << walk[i].tag << " " << walk[i].flags << " " << (int)walk[i].channel << " " << (int)walk[i].num << std::endl;
 // #endif
 
+	/* Duplicate last entry to fill out the table */
+	search.resize(search_size, search.back());
+
+	used_conditions = id_space.size()/2;
+
+	// Nothing to do if the active tables are already correct
+	TableBank &active = table_banks[1];
+	if (active.valid && active.search == search && active.walk == walk) {
+		return;
+	}
+
+	// Only write the entries that differ from the content of the inactive bank.
+	// If the upload fails halfway, the content of the bank is unknown.
+	TableBank &inactive = table_banks[0];
+	bool known = inactive.valid;
+	inactive.valid = false;
+
+	// Upload the changed entries with as few cycles as possible. Every cycle.close() waits
+	// for the device to answer, but the bus is locked while a cycle is open, so the number
+	// of writes in one cycle is limited.
 	etherbone::Cycle cycle;
+	unsigned writes = 0;
+	auto reserve = [&](unsigned n) {
+		if (writes > 0 && writes + n > max_writes_per_cycle) {
+			cycle.close();
+			writes = 0;
+		}
+		if (writes == 0) {
+			cycle.open(device);
+		}
+		writes += n;
+	};
+
 	for (unsigned i = 0; i < search_size; ++i) {
-		/* Duplicate last entry to fill out the table */
-		const SearchEntry& se = (i<search.size())?search[i]:search.back();
+		const SearchEntry& se = search[i];
+		if (known && inactive.search[i] == se) {
+			continue;
+		}
 		
-		cycle.open(device);
+		reserve(5);
 		cycle.write(adr_first + ECA_SEARCH_SELECT_RW,      EB_DATA32, i);
 		cycle.write(adr_first + ECA_SEARCH_RW_FIRST_RW,    EB_DATA32, (uint16_t)se.index);
 		cycle.write(adr_first + ECA_SEARCH_RW_EVENT_HI_RW, EB_DATA32, se.event >> 32);
 		cycle.write(adr_first + ECA_SEARCH_RW_EVENT_LO_RW, EB_DATA32, (uint32_t)se.event);
 		cycle.write(adr_first + ECA_SEARCH_WRITE_OWR,      EB_DATA32, 1);
-		cycle.close();
 	}
 	
 	for (unsigned i = 0; i < walk.size(); ++i) {
 		const WalkEntry& we = walk[i];
+		if (known && i < inactive.walk.size() && inactive.walk[i] == we) {
+			continue;
+		}
 		
-		cycle.open(device);
+		reserve(9);
 		cycle.write(adr_first + ECA_WALKER_SELECT_RW,       EB_DATA32, i);
 		cycle.write(adr_first + ECA_WALKER_RW_NEXT_RW,      EB_DATA32, (uint16_t)we.next);
 		cycle.write(adr_first + ECA_WALKER_RW_OFFSET_HI_RW, EB_DATA32, (uint64_t)we.offset >> 32); // don't sign-extend on shift
@@ -537,13 +668,17 @@ void ECA::compile()
 		cycle.write(adr_first + ECA_WALKER_RW_CHANNEL_RW,   EB_DATA32, we.channel);
 		cycle.write(adr_first + ECA_WALKER_RW_NUM_RW,       EB_DATA32, we.num);
 		cycle.write(adr_first + ECA_WALKER_WRITE_OWR,       EB_DATA32, 1);
-		cycle.close();
 	}
+
+	// Flip the tables in the same cycle as the last table writes
+	reserve(1);
+	cycle.write(adr_first + ECA_FLIP_ACTIVE_OWR, EB_DATA32, 1);
+	cycle.close();
 	
-	// Flip the tables
-	device.write(adr_first + ECA_FLIP_ACTIVE_OWR, EB_DATA32, 1);
-	
-	used_conditions = id_space.size()/2;
+	inactive.search.swap(search);
+	inactive.walk.swap(walk);
+	inactive.valid = true;
+	std::swap(table_banks[0], table_banks[1]);
 }
 
 
@@ -577,8 +712,35 @@ ECA::ECA(SAFTd &saftd, etherbone::Device &dev, const std::string &obj_path, saft
 	, object_path(obj_path)
 	, container(cont)
 	, sas_count(0)
+	, max_writes_per_cycle(100) // about 12 bytes per write: one cycle fits into a 1500 byte Etherbone UDP packet
+	, compile_deferrals(0)
+	, compile_pending(false)
+	, counter_refresh_period(10)
 {
 	// std::cerr << "ECA::ECA() object_path " << object_path << std::endl;
+	char *counter_period_env = getenv("SAFTLIB_ECA_COUNTER_REFRESH_PERIOD");
+	if (counter_period_env != nullptr) {
+		std::istringstream in(counter_period_env);
+		unsigned period_ms;
+		in >> period_ms;
+		if (!in) {
+			std::cerr << "cannot read counter refresh period (ms) from environment variable SAFTLIB_ECA_COUNTER_REFRESH_PERIOD: \'" << counter_period_env << "\'" << std::endl;
+		} else {
+			counter_refresh_period = std::chrono::milliseconds(period_ms);
+		}
+	}
+	char *max_writes_env = getenv("SAFTLIB_ECA_MAX_WRITES_PER_CYCLE");
+	if (max_writes_env != nullptr) {
+		std::istringstream in(max_writes_env);
+		unsigned max_writes;
+		in >> max_writes;
+		if (!in || max_writes < 9) {
+			// a walker entry needs 9 writes
+			std::cerr << "cannot read max writes per cycle (>= 9) from environment variable SAFTLIB_ECA_MAX_WRITES_PER_CYCLE: \'" << max_writes_env << "\'" << std::endl;
+		} else {
+			max_writes_per_cycle = max_writes;
+		}
+	}
 	probeConfiguration();
 	compile(); // remove old rules
 	prepareChannels();
@@ -592,6 +754,7 @@ ECA::ECA(SAFTd &saftd, etherbone::Device &dev, const std::string &obj_path, saft
 ECA::~ECA() 
 {
 	// std::cerr << "ECA::~ECA()" << std::endl;
+	saftbus::Loop::get_default().remove(counter_refresh_timeout);
 	if (container) {
 		for (auto &channel: ECAchannels) {
 			for (auto &actionSink: channel) {
@@ -31,10 +31,12 @@
 #include <etherbone.h>
 
 #include <saftbus/service.hpp>
+#include <saftbus/loop.hpp>
 
 #include "MsiDevice.hpp"
 
 #include <memory>
+#include <chrono>
 
 
 namespace saftlib {
@@ -72,6 +74,55 @@ class ECA : public MsiDevice {
 	unsigned max_conditions;
 	unsigned used_conditions;
 	std::vector<eb_address_t> channel_msis;
+
+	// Entries of the search and walker tables as they are stored in hardware (see compile())
+	struct SearchEntry {
+		uint64_t event;
+		int16_t  index;
+		SearchEntry(uint64_t e, int16_t i) : event(e), index(i) { }
+		bool operator==(const SearchEntry &rhs) const { return event == rhs.event && index == rhs.index; }
+	};
+	struct WalkEntry {
+		int16_t   next;
+		int64_t   offset;
+		uint32_t  tag;
+		uint8_t   flags;
+		unsigned channel;
+		unsigned num;
+		bool operator==(const WalkEntry &rhs) const { 
+			return next == rhs.next && offset == rhs.offset && tag == rhs.tag && 
+			       flags == rhs.flags && channel == rhs.channel && num == rhs.num; 
+		}
+	};
+	// The ECA has two banks of tables. compile() writes the inactive bank and flips the banks.
+	// A copy of both banks is kept, so that compile() only needs to write entries that changed.
+	struct TableBank {
+		std::vector<SearchEntry> search;
+		std::vector<WalkEntry>   walk;
+		bool valid; // false if the content of the bank in hardware is unknown
+		TableBank() : valid(false) { }
+	};
+	TableBank table_banks[2]; // [0]: inactive bank (written by the next compile), [1]: active bank
+	unsigned max_writes_per_cycle; // compile() splits the table upload into Etherbone cycles of at most this many writes
+	unsigned compile_deferrals;    // number of open deferCompile() calls
+	bool     compile_pending;      // compile() was called while it was deferred
+
+	// Counter refreshes that were requested by MSIs of all ActionSinks. They are read 
+	// together in one Etherbone cycle, at most once per counter_refresh_period.
+	struct CounterRefresh {
+		ActionSink *sink;
+		uint8_t     code; // ECA_OVERFLOW, ECA_VALID, ECA_LATE, ECA_EARLY, ECA_CONFLICT, or ECA_DELAYED
+		std::chrono::steady_clock::time_point due; // earliest refresh allowed by the SignalRate of the sink
+	};
+	std::vector<CounterRefresh> counter_refreshes;
+	std::chrono::milliseconds   counter_refresh_period; // from SAFTLIB_ECA_COUNTER_REFRESH_PERIOD
+	std::chrono::steady_clock::time_point counter_refresh_last;      // time of the last refresh cycle
+	std::chrono::steady_clock::time_point counter_refresh_scheduled; // time when counter_refresh_timeout fires
+	saftbus::SourceHandle       counter_refresh_timeout;
+	void requestCounterRefresh(ActionSink *sink, uint8_t code, std::chrono::steady_clock::time_point due);
+	void cancelCounterRefreshes(ActionSink *sink);
+	void scheduleCounterRefresh();
+	bool refreshCounters();
 	std::vector<eb_address_t> queue_addresses;
 	std::vector<uint16_t> most_full;
 
@@ -100,6 +151,12 @@ public:
 	const std::string &get_object_path();
 	etherbone::Device &get_device();
 	void compile();
+	/// @brief compile() only remembers that the tables must be rebuilt until resumeCompile() is called.
+	///
+	/// Calls can be nested. Used by ActionSink::BeginConditionBatch.
+	void deferCompile();
+	/// @brief End one deferCompile(). After the last one, the deferred compile() is done if recompile is true.
+	void resumeCompile(bool recompile = true);
 	// typedef std::pair<unsigned, unsigned> SinkKey; // (channel, num)
 
 
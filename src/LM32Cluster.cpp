@@ -26,7 +26,17 @@
 #include <iostream>
 #include <cassert>
 #include <sstream>
-#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #define LM32_RAM_USER_VENDOR      0x0651             // vendor ID
 #define LM32_RAM_USER_PRODUCT     0x54111351         // product ID
@@ -42,9 +52,27 @@ namespace saftlib {
 LM32Cluster::LM32Cluster(etherbone::Device &dev, TimingReceiver *timing_receiver) 
 	: SdbDevice(dev, LM32_CLUSTER_ROM_VENDOR, LM32_CLUSTER_ROM_PRODUCT)
 	, tr(timing_receiver)
+	, max_writes_per_cycle(255) // the most writes that fit into one Etherbone record, about 1 kB per cycle
+	, firmware_diff(false)
 {
 	std::cerr << "LM32Cluster::LM32Cluster" << std::endl;
 
+	char *max_writes_env = getenv("SAFTLIB_LM32_MAX_WRITES_PER_CYCLE");
+	if (max_writes_env != nullptr) {
+		std::istringstream in(max_writes_env);
+		unsigned max_writes;
+		in >> max_writes;
+		if (!in || max_writes < 1) {
+			std::cerr << "cannot read max writes per cycle (>= 1) from environment variable SAFTLIB_LM32_MAX_WRITES_PER_CYCLE: \'" << max_writes_env << "\'" << std::endl;
+		} else {
+			max_writes_per_cycle = max_writes;
+		}
+	}
+	char *diff_env = getenv("SAFTLIB_LM32_FIRMWARE_DIFF");
+	if (diff_env != nullptr) {
+		firmware_diff = std::string(diff_env) == "1";
+	}
+
     eb_data_t cpus;
     device.read(adr_first, EB_DATA32, &cpus);
 
@@ -91,7 +119,7 @@ void LM32Cluster::SafeHaltCpu(unsigned cpu_idx)
 	while (adr < last) {
 		etherbone::Cycle cycle;
 		cycle.open(device);
-		for (int i = 0; i < 32 && adr < last; ++i) {
+		for (unsigned i = 0; i < max_writes_per_cycle && adr < last; ++i) {
 			cycle.write(adr, EB_DATA32, (eb_data_t)jump_instruction);
 			adr += 4;
 		}
@@ -100,6 +128,48 @@ void LM32Cluster::SafeHaltCpu(unsigned cpu_idx)
 	tr->CpuHalt(cpu_idx);
 }
 
+// Read-only view of a firmware binary, mapped copy-on-write so that the words can be swapped in place.
+struct FirmwareImage {
+	uint32_t *words;
+	size_t    size; // in bytes
+	FirmwareImage(const std::string &filename) : words(nullptr), size(0) {
+		int fd = open(filename.c_str(), O_RDONLY);
+		struct stat st;
+		if (fd < 0 || fstat(fd, &st) != 0) {
+			if (fd >= 0) close(fd);
+			std::ostringstream msg;
+			msg << "cannot open firmware binary file " << filename << ": " << strerror(errno);
+			throw std::runtime_error(msg.str());
+		}
+		size = st.st_size;
+		if (size > 0) {
+			void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED) {
+				close(fd);
+				std::ostringstream msg;
+				msg << "cannot map firmware binary file " << filename << ": " << strerror(errno);
+				throw std::runtime_error(msg.str());
+			}
+			words = static_cast<uint32_t*>(data);
+		}
+		close(fd);
+	}
+	~FirmwareImage() {
+		if (words) {
+			munmap(words, size);
+		}
+	}
+};
+
+// The firmware words are stored big endian. The loop has no dependencies between iterations,
+// the compiler turns it into vector byte shuffles.
+static void swap_bytes(uint32_t *words, size_t n)
+{
+	for (size_t i = 0; i < n; ++i) {
+		words[i] = __builtin_bswap32(words[i]);
+	}
+}
+
 void LM32Cluster::WriteFirmware(unsigned cpu_idx, const std::string &filename)
 {
 	if (cpu_idx >= num_cores) {
@@ -107,38 +177,57 @@ void LM32Cluster::WriteFirmware(unsigned cpu_idx, const std::string &filename)
 		msg << "there is no user cpu core with index " << cpu_idx;
 		throw std::runtime_error(msg.str());	
 	}
-	eb_address_t adr = dpram_lm32_adr_first[cpu_idx];
-	eb_address_t last = dpram_lm32_adr_last[cpu_idx];
-	std::ifstream firmware_bin(filename.c_str());
-	if (!firmware_bin) {
-		std::ostringstream msg;
-		msg << "cannot open firmware binary file " << filename;
-		throw std::runtime_error(msg.str());
+	auto start = std::chrono::steady_clock::now();
+
+	eb_address_t first = dpram_lm32_adr_first[cpu_idx];
+	eb_address_t last  = dpram_lm32_adr_last[cpu_idx];
+	FirmwareImage firmware(filename);
+	// an incomplete word at the end of the file is ignored, words that don't fit into the RAM are dropped
+	size_t n_words = std::min<size_t>(firmware.size / 4, (last - first + 1) / 4);
+	swap_bytes(firmware.words, n_words);
+
+	// in diff mode, the RAM content is read in cycles of the same size as the writes
+	std::vector<eb_data_t> ram;
+	if (firmware_diff) {
+		ram.resize(n_words);
+		for (size_t i = 0; i < n_words; ) {
+			etherbone::Cycle cycle;
+			cycle.open(device);
+			for (unsigned j = 0; j < max_writes_per_cycle && i < n_words; ++j, ++i) {
+				cycle.read(first + 4*i, EB_DATA32, &ram[i]);
+			}
+			cycle.close();
+		}
 	}
 
-	bool end_of_file = false;
-	while (adr < last) {
+	size_t written = 0;
+	for (size_t i = 0; i < n_words; ) {
 		etherbone::Cycle cycle;
-		cycle.open(device);
-		for (int i = 0; i < 32 && adr < last; ++i) {
-			uint32_t instr, cpu_instr = 0;
-			firmware_bin.read((char*)&instr, sizeof(instr));
-			if (!firmware_bin) {
-				end_of_file = true;
-				break;
+		unsigned writes = 0;
+		for (; writes < max_writes_per_cycle && i < n_words; ++i) {
+			if (firmware_diff && ram[i] == firmware.words[i]) {
+				continue;
 			}
-			cpu_instr |= instr >> 24;
-			cpu_instr |= (0xff0000 & instr) >> 8;
-			cpu_instr |= (0x00ff00 & instr) << 8;
-			cpu_instr |= instr << 24;
-			cycle.write(adr, EB_DATA32, (eb_data_t)cpu_instr);
-			adr += 4;
+			if (writes == 0) {
+				cycle.open(device);
+			}
+			cycle.write(first + 4*i, EB_DATA32, (eb_data_t)firmware.words[i]);
+			++writes;
 		}
-		cycle.close();
-		if (end_of_file) {
-			break;
+		if (writes > 0) {
+			cycle.close();
 		}
+		written += writes;
+	}
+
+	auto stop = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration_cast<std::chrono::microseconds>(stop-start).count() / 1e6;
+	std::cerr << "firmware " << filename << " loaded into cpu[" << cpu_idx << "]: " 
+	          << written << " of " << n_words << " words written in " << seconds*1e3 << " ms";
+	if (seconds > 0) {
+		std::cerr << " (" << 4*n_words/seconds/1024 << " kB/s)";
 	}
+	std::cerr << std::endl;
 }
 
-} // namespace
\ No newline at end of file
+} // namespace
@@ -50,6 +50,8 @@ class LM32Cluster : public SdbDevice {
 	unsigned num_cores;
 	unsigned ram_per_core;
 	TimingReceiver *tr;
+	unsigned max_writes_per_cycle; // RAM uploads are split into Etherbone cycles of at most this many writes
+	bool firmware_diff;            // WriteFirmware reads the RAM first and writes only the words that differ
 public:
 	LM32Cluster(etherbone::Device &device, TimingReceiver *tr);
 	~LM32Cluster();
@@ -70,6 +72,13 @@ public:
 	// @saftbus-export
 	void SafeHaltCpu(unsigned cpu_idx);
 
+	/// @brief write a firmware binary into the RAM of cpu[cpu_idx]
+	/// @param cpu_idx identifies the cpu 
+	/// @param filename the firmware binary (big endian words)
+	///
+	/// The file is mapped into memory and uploaded in Etherbone cycles of SAFTLIB_LM32_MAX_WRITES_PER_CYCLE (default 255) writes.
+	/// If the environment variable SAFTLIB_LM32_FIRMWARE_DIFF is set to 1, the RAM content is read first 
+	/// and only words that differ from the file are written.
 	void WriteFirmware(unsigned cpu_idx, const std::string &filename);
 };
 
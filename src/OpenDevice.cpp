@@ -23,11 +23,13 @@
 #include "Mailbox.hpp"
 #include "SAFTd.hpp"
 #include "eb-forward.hpp"
+#include "eb-source.hpp"
 
 #include <saftbus/error.hpp>
 
 #include <iostream>
 #include <functional>
+#include <algorithm>
 #include <cassert>
 
 namespace saftlib {
@@ -42,60 +44,85 @@ void OpenDevice::check_msi_callback(eb_data_t value)
 	if (check_irq) check_irq.reset();
 	// saftd->release_irq(irq_adr);
 }
-bool OpenDevice::poll_msi(bool only_once) {
+// Not more MSIs than this are read in one Etherbone cycle, to not block the event loop for too long.
+static const unsigned MAX_MSI_SLOTS = 16;
+
+bool OpenDevice::poll_msi() {
 	// std::cerr << "OpenDevice::poll_msi" << std::endl;
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	// The MSIs are read from the eb-slave config registers. Each read of the three
+	// registers takes one MSI from the slave, several of them are pipelined in one cycle.
+	eb_data_t msi_adr[MAX_MSI_SLOTS];
+	eb_data_t msi_dat[MAX_MSI_SLOTS];
+	eb_data_t msi_cnt[MAX_MSI_SLOTS];
 	etherbone::Cycle cycle;
-	eb_data_t msi_adr = 0;
-	eb_data_t msi_dat = 0;
-	eb_data_t msi_cnt = 0;
-	bool found_msi = false;
-	const int MAX_MSIS_IN_ONE_GO = 5; // not too many MSIs at once to not block event loop for too long 
-	for (int i = 0; i < MAX_MSIS_IN_ONE_GO; ++i) { // never more this many MSIs in one go
-		cycle.open(device);
-		cycle.read_config(0x40, EB_DATA32, &msi_adr);
-		cycle.read_config(0x44, EB_DATA32, &msi_dat);
-		cycle.read_config(0x48, EB_DATA32, &msi_cnt);
-		cycle.close();
-		if (msi_cnt & 1) {
-			msi_adr = first + (msi_adr & mask);
-			needs_polling = true; // this value is 
-			found_msi = true;
-			saftd->write(msi_adr, EB_DATA32, msi_dat); // this functon is normally called by etherbone::Socket when it receives an MSI
-		}
-		if (!(msi_cnt & 2)) { // no more msi to poll (second bit of msi_cnt is not set)
-			break; 
+	cycle.open(device);
+	for (unsigned i = 0; i < msi_slots; ++i) {
+		cycle.read_config(0x40, EB_DATA32, &msi_adr[i]);
+		cycle.read_config(0x44, EB_DATA32, &msi_dat[i]);
+		cycle.read_config(0x48, EB_DATA32, &msi_cnt[i]);
+	}
+	cycle.close();
+	unsigned found_msis = 0;
+	for (unsigned i = 0; i < msi_slots; ++i) {
+		if (msi_cnt[i] & 1) {
+			needs_polling = true; 
+			++found_msis;
+			saftd->write(first + (msi_adr[i] & mask), EB_DATA32, msi_dat[i]); // this functon is normally called by etherbone::Socket when it receives an MSI
 		}
 	}
-	if ((msi_cnt & 2) || found_msi) {
-		// if we polled MAX_MSIS_IN_ONE_GO but there are more MSIs (second bit of msi_cnt is set)
-		// OR if there was at least one MSI present 
-		// we have to schedule the next check immediately because the 
-		// MSI we just polled may cause actions that trigger other MSIs.
-		// however, this TimeoutSource will be called only once, because the only_once argument is true
-		bool only_once;
-		// std::cerr << "add an only_once timeout source" << std::endl;
-		poll_once = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
-				std::bind(&OpenDevice::poll_msi, this, only_once=true), std::chrono::milliseconds(0), std::chrono::milliseconds(0)
-			);
-	} 
-
-	if (only_once) {
-		// std::cerr << "polled only_once " << found_msi << std::endl;
-		// returning false removes the TimeoutSource from the event loop
-		return false;
+	bool more_msis = msi_cnt[msi_slots-1] & 2; // second bit of msi_cnt is set if more MSIs are waiting
+
+	++poll_count;
+	if (found_msis > 0) {
+		std::chrono::microseconds latency = std::chrono::duration_cast<std::chrono::microseconds>(now - last_poll);
+		++poll_hits;
+		msi_count   += found_msis;
+		latency_sum += latency;
+		latency_max  = std::max(latency_max, latency);
 	}
+	last_poll = now;
+
 	if (!check_msi_phase && !needs_polling) {
 		// return false if checking phase is over, and we found out that no polling is needed 
+		poll_timeout_source = saftbus::SourceHandle();
+		return false;
+	}
+
+	if (found_msis > 0 || more_msis) {
+		// The MSIs we just polled may cause actions that trigger other MSIs: poll again immediately
+		// and continue with the shortest interval. Read more MSIs per cycle while the slave has more waiting.
+		polling_interval = min_polling_interval;
+		msi_slots = more_msis ? std::min(2*msi_slots, MAX_MSI_SLOTS) : std::max(msi_slots, found_msis);
+		poll_timeout_source = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
+				std::bind(&OpenDevice::poll_msi, this), polling_interval, std::chrono::microseconds(0)
+			);
+		return false;
+	}
+	// Without MSIs, back off exponentially (with a fixed interval, max_polling_interval == min_polling_interval) 
+	// and slowly go back to reading one MSI per cycle.
+	msi_slots = std::max(msi_slots/2, 1u);
+	std::chrono::microseconds next_interval = std::min(2*polling_interval, max_polling_interval);
+	if (next_interval != polling_interval) {
+		// replace this TimeoutSource by one with the new interval
+		polling_interval = next_interval;
+		poll_timeout_source = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
+				std::bind(&OpenDevice::poll_msi, this), polling_interval, polling_interval
+			);
 		return false;
 	}
 	return true;
 }
 
-OpenDevice::OpenDevice(const etherbone::Socket &socket, const std::string& eb_path, int polling_iv_ms, SAFTd *sd)
-	: etherbone_path(eb_path), eb_forward_path(eb_path), polling_interval_ms(polling_iv_ms), saftd(sd), check_msi_phase(true), needs_polling(false) 
+OpenDevice::OpenDevice(const etherbone::Socket &socket, const std::string& eb_path, std::chrono::microseconds polling_iv, SAFTd *sd, std::chrono::microseconds max_polling_iv)
+	: etherbone_path(eb_path), eb_forward_path(eb_path)
+	, polling_interval(polling_iv), min_polling_interval(polling_iv), max_polling_interval(std::max(polling_iv, max_polling_iv)), msi_slots(1)
+	, poll_count(0), poll_hits(0), msi_count(0), latency_sum(0), latency_max(0)
+	, saftd(sd), check_msi_phase(true), needs_polling(false) 
 {
 	std::cerr << "OpenDevice::OpenDevice(\"" << eb_path << "\")" << std::endl;
 	device.open(socket, etherbone_path.c_str());
+	EB_Source::descriptors_changed();
 	stat(etherbone_path.c_str(), &dev_stat);
 	device.enable_msi(&first, &last);
 	mask = last-first;
@@ -111,11 +138,11 @@ OpenDevice::OpenDevice(const etherbone::Socket &socket, const std::string& eb_pa
 			std::cerr << "msi_target_adr for poll check: " << std::hex << std::setw(8) << std::setfill('0') << check_irq->address() << std::dec << std::endl;
 			auto slot = mbox->ConfigureSlot(check_irq->address());
 			slot->Use(MSI_TEST_VALUE); // make one single irq that should call our check_msi_callback
-			bool only_once;
+			last_poll = std::chrono::steady_clock::now();
 			poll_timeout_source = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
-					std::bind(&OpenDevice::poll_msi, this, only_once=false), 
-					std::chrono::milliseconds(polling_interval_ms),
-					std::chrono::milliseconds(polling_interval_ms)
+					std::bind(&OpenDevice::poll_msi, this), 
+					polling_interval,
+					polling_interval
 				);
 		}
 
@@ -134,9 +161,9 @@ OpenDevice::~OpenDevice()
 {
 	if (check_irq) check_irq.reset();
 	saftbus::Loop::get_default().remove(poll_timeout_source);
-	saftbus::Loop::get_default().remove(poll_once);
 	chmod(etherbone_path.c_str(), dev_stat.st_mode);
 	device.close();
+	EB_Source::descriptors_changed();
 }
 
 etherbone::Device &OpenDevice::get_device()
@@ -155,5 +182,22 @@ std::string OpenDevice::getEbForwardPath() const
 	return eb_forward_path;
 }
 
+std::map<std::string, uint64_t> OpenDevice::getMsiPollStatistics() const
+{
+	std::map<std::string, uint64_t> statistics;
+	if (!needs_polling) {
+		return statistics;
+	}
+	statistics["polls"]           = poll_count;
+	statistics["polls_with_msi"]  = poll_hits;
+	statistics["msis"]            = msi_count;
+	statistics["interval_us"]     = polling_interval.count();
+	statistics["min_interval_us"] = min_polling_interval.count();
+	statistics["max_interval_us"] = max_polling_interval.count();
+	statistics["latency_mean_us"] = poll_hits ? latency_sum.count()/poll_hits : 0;
+	statistics["latency_max_us"]  = latency_max.count();
+	return statistics;
+}
+
 
 } // namespace
@@ -32,6 +32,9 @@
 #include <saftbus/loop.hpp>
 
 #include <memory>
+#include <map>
+#include <string>
+#include <chrono>
 
 #include <sys/stat.h>
 
@@ -53,6 +56,10 @@ class EB_Forward;
 ///  - if the polling function is called and finds the specific MSI value, it continues to poll
 ///  - if the MSI callback function is called despite of the polling function not seeing the MSI value, the polling function will be removed from the event loop
 ///
+/// If a poll finds an MSI (or the slave reports more waiting MSIs), the next poll follows immediately.
+/// If MSIs are polled and a max_polling_interval larger than polling_interval is given, the polling interval adapts:
+/// it drops to polling_interval while MSIs arrive and doubles with each poll that finds no MSI, up to max_polling_interval.
+///
 class OpenDevice {
 protected:
 	std::string etherbone_path;
@@ -63,9 +70,11 @@ public:
 	/// @brief open given etherbone_path on given socket. 
 	/// @param socket the etherbone Socket
 	/// @param etherbone_path path of the etherbone device
-	/// @param polling_interval_ms in case of hardware without native MSIs
+	/// @param polling_interval in case of hardware without native MSIs (microsecond resolution)
 	/// @param saftd must be a valid pointer if MSIs are used
-	OpenDevice(const etherbone::Socket &socket, const std::string& etherbone_path, int polling_interval_ms = 1, SAFTd *saftd = nullptr);
+	/// @param max_polling_interval upper bound for the adaptive polling interval. If it is not larger than polling_interval, the interval is fixed.
+	OpenDevice(const etherbone::Socket &socket, const std::string& etherbone_path, std::chrono::microseconds polling_interval = std::chrono::milliseconds(1), SAFTd *saftd = nullptr, 
+	           std::chrono::microseconds max_polling_interval = std::chrono::microseconds(0));
 	virtual ~OpenDevice();
 
 	etherbone::Device &get_device();
@@ -86,16 +95,33 @@ public:
 	// @saftbus-export
 	std::string getEbForwardPath() const;
 
+	/// @brief Statistics of the MSI polling for devices without native MSI support
+	/// @return counters and times (in microseconds) of the MSI polling:
+	///         polls, polls_with_msi, msis, interval_us, min_interval_us, max_interval_us,
+	///         latency_mean_us, latency_max_us.
+	///         The latency is the time between a poll that found an MSI and the poll before,
+	///         which is an upper bound for the time the MSI was waiting.
+	///         The map is empty if the device delivers MSIs without polling.
+	///
+	// @saftbus-export
+	std::map<std::string, uint64_t> getMsiPollStatistics() const;
+
 private:
 	// etherbone forwading
 	std::unique_ptr<EB_Forward> eb_forward;
 	std::string eb_forward_path;
 
 	// polling for MSIs on hardware that doesn't support real MSIs
-	bool poll_msi(bool only_once);
-	int polling_interval_ms;
+	bool poll_msi();
+	std::chrono::microseconds polling_interval;     // current interval
+	std::chrono::microseconds min_polling_interval; // while MSIs arrive
+	std::chrono::microseconds max_polling_interval; // after a long time without MSIs
+	unsigned msi_slots;                             // number of MSIs that are read in the next poll
 	saftbus::SourceHandle poll_timeout_source;
-	saftbus::SourceHandle poll_once;
+	// polling statistics
+	std::chrono::steady_clock::time_point last_poll;
+	uint64_t poll_count, poll_hits, msi_count;
+	std::chrono::microseconds latency_sum, latency_max;
 
 	// following members are for testing MSI capability (real or polled MSIs)
 	void check_msi_callback(eb_data_t value);
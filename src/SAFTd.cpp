@@ -23,6 +23,8 @@
 #include <iomanip>
 #include <sstream>
 #include <cstring>
+#include <cstdlib>
+#include <thread>
 
 #include <saftbus/error.hpp>
 #include <saftbus/loop.hpp>
@@ -42,6 +44,62 @@ extern "C" void destroy_service();
 
 namespace saftlib {
 
+	// The eb_slave device that receives the MSIs of one device thread. 
+	// All MSIs are passed to SAFTd::write, which runs in the device thread.
+	struct SAFTd::DeviceThread : public etherbone::Handler {
+		DeviceThread(SAFTd *saftd, sdb_device *eb_slave_sdb);
+		~DeviceThread();
+		eb_status_t read (eb_address_t address, eb_width_t width, eb_data_t* data) override;
+		eb_status_t write(eb_address_t address, eb_width_t width, eb_data_t data) override;
+
+		SAFTd *saftd;
+		etherbone::Socket socket;
+		std::map<eb_address_t, std::function<void(eb_data_t)> > irqs;
+		saftbus::Loop loop;
+		std::thread thread;
+
+		// the DeviceThread that runs in the calling thread, nullptr in all other threads
+		static thread_local DeviceThread *current;
+	};
+
+	thread_local SAFTd::DeviceThread *SAFTd::DeviceThread::current = nullptr;
+
+	SAFTd::DeviceThread::DeviceThread(SAFTd *sd, sdb_device *eb_slave_sdb) 
+		: saftd(sd)
+	{
+		socket.open();
+		socket.attach(eb_slave_sdb, this);
+		loop.connect<saftlib::EB_Source>(socket);
+		thread = std::thread([this]() {
+			saftbus::Loop::set_thread_default(&loop);
+			current = this;
+			loop.run();
+		});
+	}
+
+	SAFTd::DeviceThread::~DeviceThread()
+	{
+		// Without sources, the loop returns at the end of the current iteration. 
+		// Nothing in this thread can wait for saftbusd anymore when join is called.
+		loop.invoke_and_wait([this]() {
+			loop.clear();
+			loop.quit();
+		});
+		thread.join();
+		try {
+			socket.close();
+		} catch (etherbone::exception_t &e) {
+		}
+	}
+
+	eb_status_t SAFTd::DeviceThread::read(eb_address_t address, eb_width_t width, eb_data_t* data) {
+		return saftd->read(address, width, data);
+	}
+
+	eb_status_t SAFTd::DeviceThread::write(eb_address_t address, eb_width_t width, eb_data_t data) {
+		return saftd->write(address, width, data);
+	}
+
 	SAFTd::SAFTd(saftbus::Container *cont)
 		: container(cont)
 		, object_path("/de/gsi/saftlib")
@@ -63,7 +121,15 @@ namespace saftlib {
 		socket.attach(&eb_slave_sdb, this);
 
 		// connect the eb-source to saftbus::Loop in order to react on incoming MSIs from hardware
-		eb_source = saftbus::Loop::get_default().connect<saftlib::EB_Source>(socket);
+		loop = &saftbus::Loop::get_default();
+		eb_source = loop->connect<saftlib::EB_Source>(socket);
+
+		char *device_threads_env = getenv("SAFTLIB_DEVICE_THREADS");
+		use_device_threads = device_threads_env != nullptr && std::string(device_threads_env) == "1";
+		if (use_device_threads) {
+			// The device threads invoke functions in this loop while this thread waits for them (see Loop::invoke_and_wait).
+			saftbus::Loop::set_thread_default(loop);
+		}
 	}
 
 	SAFTd::~SAFTd() 
@@ -78,8 +144,14 @@ namespace saftlib {
 				// nothing
 			}
 		}
-		attached_devices.clear();
-		saftbus::Loop::get_default().remove(eb_source);
+		while (!attached_devices.empty()) {
+			RemoveObject(attached_devices.begin()->first);
+		}
+		if (!stopped_device_threads.empty()) {
+			loop->remove(stop_device_threads_source);
+			stopped_device_threads.clear();
+		}
+		loop->remove(eb_source);
 		try {
 			socket.close();
 		} catch (etherbone::exception_t &e) {
@@ -96,6 +168,7 @@ namespace saftlib {
 		//           <<               " " << std::hex << std::setw(8) << std::setfill('0') << data 
 		//           << std::dec 
 		//           << std::endl;
+		auto &irqs = get_irqs();
 		std::map<eb_address_t, std::function<void(eb_data_t)> >::iterator it = irqs.find(address);
 		if (it != irqs.end()) {
 			try {
@@ -111,22 +184,41 @@ namespace saftlib {
 	}
 
 	std::string SAFTd::AttachDevice(const std::string& name, const std::string& etherbone_path, int polling_interval_ms) 
+	{
+		return AttachDevice(name, etherbone_path, std::chrono::milliseconds(polling_interval_ms));
+	}
+
+	std::string SAFTd::AttachDevice(const std::string& name, const std::string& etherbone_path, std::chrono::microseconds polling_interval, std::chrono::microseconds max_polling_interval) 
 	{
 		if (attached_devices.find(name) != attached_devices.end()) {
 	        throw saftbus::Error(saftbus::Error::INVALID_ARGS, "device already exists");
 		}
 		try {
-			// create a new TimingReceiver object and add it to the attached_devices
-			TimingReceiver *timing_receiver = new TimingReceiver(*this, name, etherbone_path, polling_interval_ms, container);
-			attached_devices[name] = std::move(std::unique_ptr<TimingReceiver>(timing_receiver));
+			TimingReceiver *timing_receiver = nullptr;
+			auto attach = [&]() {
+				// create a new TimingReceiver object
+				std::unique_ptr<TimingReceiver> device(new TimingReceiver(*this, name, etherbone_path, polling_interval, container, max_polling_interval));
 
-			// crate a TimingReceiver_Service object
-			if (container) {
-				std::unique_ptr<TimingReceiver_Service> service (new TimingReceiver_Service(timing_receiver, std::bind(&SAFTd::RemoveObject, this, name), false));
+				// crate a TimingReceiver_Service object
+				if (container) {
+					std::unique_ptr<TimingReceiver_Service> service (new TimingReceiver_Service(device.get(), std::bind(&SAFTd::RemoveObject, this, name), false));
 
-				// insert the Service object
-				container->create_object(timing_receiver->getObjectPath(), std::move(service));
+					// insert the Service object
+					container->create_object(device->getObjectPath(), std::move(service));
+				}
+				timing_receiver = device.release();
+			};
+			if (use_device_threads) {
+				// The TimingReceiver and all its Services are created in the thread of the device. 
+				// Everything that they connect to saftbus::Loop::get_default() runs in this thread.
+				std::unique_ptr<DeviceThread> device_thread(new DeviceThread(this, &eb_slave_sdb));
+				device_thread->loop.invoke_and_wait(attach);
+				device_threads[name] = std::move(device_thread);
+			} else {
+				attach();
 			}
+			// add it to the attached_devices
+			attached_devices[name] = std::move(std::unique_ptr<TimingReceiver>(timing_receiver));
 
 			// return the object path to the new Service object
 			return timing_receiver->getObjectPath();
@@ -160,8 +252,43 @@ namespace saftlib {
 	}
 
 	void SAFTd::RemoveObject(const std::string& name) {
-		std::map< std::string, std::unique_ptr<TimingReceiver> >::iterator device_driver = attached_devices.find(name);
-		attached_devices.erase(device_driver);
+		std::unique_ptr<TimingReceiver> device;
+		DeviceThread *thread = nullptr;
+		// The maps are used in the thread of saftbusd. RemoveObject runs in the thread of the device
+		// if it is the destruction callback of the TimingReceiver_Service.
+		loop->invoke_and_wait([&]() {
+			std::map< std::string, std::unique_ptr<TimingReceiver> >::iterator device_driver = attached_devices.find(name);
+			device = std::move(device_driver->second);
+			attached_devices.erase(device_driver);
+			auto device_thread = device_threads.find(name);
+			if (device_thread != device_threads.end()) {
+				// The TimingReceiver_Service may be destroyed after this (in the thread of the device),
+				// the thread is stopped in the next iteration of the Loop of saftbusd.
+				thread = device_thread->second.get();
+				if (stopped_device_threads.empty()) {
+					stop_device_threads_source = loop->connect<saftbus::TimeoutSource>([this]() {
+						stopped_device_threads.clear();
+						return false;
+					}, std::chrono::milliseconds(0));
+				}
+				stopped_device_threads.push_back(std::move(device_thread->second));
+				device_threads.erase(device_thread);
+			}
+		});
+		if (thread) {
+			// the TimingReceiver is destroyed in its own thread
+			thread->loop.invoke_and_wait([&]() { device.reset(); });
+		}
+	}
+
+	void SAFTd::run_in_device_thread(const std::string &name, const std::function<void()> &function)
+	{
+		auto device_thread = device_threads.find(name);
+		if (device_thread == device_threads.end()) {
+			function();
+		} else {
+			device_thread->second->loop.invoke_and_wait(function);
+		}
 	}
 
 	void SAFTd::Quit() {
@@ -184,8 +311,26 @@ namespace saftlib {
 		return result;
 	}
 
+	etherbone::Socket &SAFTd::get_etherbone_socket() 
+	{
+		if (DeviceThread::current) {
+			return DeviceThread::current->socket;
+		}
+		return socket;
+	}
+
+	// the MSI addresses are allocated per etherbone::Socket
+	std::map<eb_address_t, std::function<void(eb_data_t)> > &SAFTd::get_irqs()
+	{
+		if (DeviceThread::current) {
+			return DeviceThread::current->irqs;
+		}
+		return irqs;
+	}
+
 	bool SAFTd::request_irq(eb_address_t irq, const std::function<void(eb_data_t)>& slot) 
 	{
+		auto &irqs = get_irqs();
 		auto it = irqs.find(irq);
 		if (it == irqs.end()) {
 			// the requested address is still free
@@ -197,6 +342,7 @@ namespace saftlib {
 		return false;
 	}
 	void SAFTd::release_irq(eb_address_t irq) {
+		auto &irqs = get_irqs();
 		auto it = irqs.find(irq);
 		if (it != irqs.end()) {
 			// std::cerr << "release_irq " << std::hex << irq << std::endl;
@@ -28,6 +28,7 @@
 #include <string>
 #include <functional>
 #include <map>
+#include <vector>
 
 #include "TimingReceiver.hpp"
 #include "eb-forward.hpp"
@@ -75,6 +76,12 @@ namespace saftlib {
 		///                            devices that have no native MSI support
 		/// @return      Object path of the created device
 		///
+		/// If the environment variable SAFTLIB_DEVICE_THREADS is set to 1, every device gets its own 
+		/// etherbone::Socket, saftbus::Loop and thread. The MSIs, timers and etherbone traffic of 
+		/// one device don't delay the other devices then. saftbus calls to the Service objects of the device 
+		/// are executed in its thread, saftbusd handles other clients meanwhile and sends the reply when 
+		/// the call is finished. Plugins must use the TimingReceiver in that thread (see run_in_device_thread).
+		///
 		/// Devices are attached to saftlib by specifying a name and a path.  The
 		/// name should denote the logical relationship of the device to saftd. 
 		/// For example, baseboard would be a good name for the timing receiver
@@ -88,6 +95,13 @@ namespace saftlib {
 		///
 		// @saftbus-export
 		std::string AttachDevice(const std::string& name, const std::string& path, int polling_interval_ms = 1);
+		/// @brief Same as AttachDevice above, but the MSI polling interval has microsecond resolution.
+		///
+		/// Polling intervals below 1 ms are only available locally (e.g. in the saftd plugin arguments).
+		/// If max_polling_interval is larger than polling_interval, the polling interval adapts 
+		/// between the two values: it is short while MSIs arrive and grows while there are none.
+		std::string AttachDevice(const std::string& name, const std::string& path, std::chrono::microseconds polling_interval, 
+		                         std::chrono::microseconds max_polling_interval = std::chrono::microseconds(0));
 
 		/// @brief Remove the device from saftlib management.
 		///
@@ -163,12 +177,26 @@ namespace saftlib {
 		std::string getObjectPath();
 
 		/// @brief access the underlying ehterbone::Socket
-		etherbone::Socket &get_etherbone_socket() { return socket; }
+		///
+		/// In the thread of a device (see AttachDevice), this is the socket of that device.
+		etherbone::Socket &get_etherbone_socket();
 
 		/// @brief access any of the managed TimingReciever driver objects
+		///
+		/// With device threads (see AttachDevice), the TimingReceiver must only be used in the thread 
+		/// of its device, see run_in_device_thread.
 		/// @return a pointer to the TimingReceiver, thwows if object_path was not found
 		TimingReceiver* getTimingReceiver(const std::string &object_path);
 
+		/// @brief call function in the thread of a device and wait for it.
+		///
+		/// Plugins that use the TimingReceiver of a device directly (e.g. to install a TimingReceiverAddon 
+		/// or to upload firmware) must do that in the thread of the device, because the device has 
+		/// its own etherbone::Socket and MSIs there. Services that are created in function belong 
+		/// to the thread of the device. Without device threads, function is called directly.
+		/// @param name the name of the device (as in AttachDevice)
+		void run_in_device_thread(const std::string &name, const std::function<void()> &function);
+
 		/// @brief Implementation of the virtual function etherbone::Handler::read
 		///
 		/// read/write virtual functions from etherbone::Handler base class are used
@@ -191,6 +219,16 @@ namespace saftlib {
 
 		void RemoveObject(const std::string& name);
 
+		// A device with its own etherbone::Socket, saftbus::Loop and thread (see AttachDevice)
+		struct DeviceThread;
+		std::map<std::string, std::unique_ptr<DeviceThread> > device_threads;
+		std::vector<std::unique_ptr<DeviceThread> > stopped_device_threads; // devices that were removed, their threads are joined soon
+		saftbus::SourceHandle stop_device_threads_source;
+		bool use_device_threads;
+		saftbus::Loop *loop; // the Loop of the thread that created SAFTd
+
+		std::map<eb_address_t, std::function<void(eb_data_t)> > &get_irqs();
+
 		// The sdb structure for this "virtual" etherbone device
 		sdb_device eb_slave_sdb;
 
@@ -32,6 +32,8 @@
 #include <cassert>
 #include <sstream>
 #include <memory>
+#include <vector>
+#include <algorithm>
 
 namespace saftlib {
 
@@ -40,7 +42,7 @@ SoftwareActionSink::SoftwareActionSink(ECA &eca
                                      , const std::string &name
                                      , unsigned channel, unsigned num, eb_address_t queue_address
                                      , saftbus::Container *container)
-	: ActionSink(eca, obj_path, name, channel, num, container), queue(queue_address)
+	: ActionSink(eca, obj_path, name, channel, num, container), queue(queue_address), drainedAhead(0)
 {
 }
 
@@ -50,6 +52,10 @@ SoftwareActionSink::SoftwareActionSink(ECA &eca
 // {
 // }
 
+// Number of queue entries that are popped in one Etherbone cycle. 
+// One entry is 12 reads and one write, the answer to 16 entries fits into one Etherbone UDP packet.
+static const unsigned max_pops_per_cycle = 16;
+
 void SoftwareActionSink::receiveMSI(uint8_t code)
 {
 	// std::cerr << "SoftwareActionSink::receiveMSI " << (int)code << std::endl;
@@ -57,68 +63,104 @@ void SoftwareActionSink::receiveMSI(uint8_t code)
 	if (code == ECA_VALID) {
 		// std::cerr << "ECA_VALID" << std::endl;
 		// DRIVER_LOG("MSI-ECA_VALID",-1, code);
+		uint64_t countBefore = actionCount;
 		updateAction(); // increase the counter, rearming the MSI
-		
-		eb_data_t flags, rawNum, event_hi, event_lo, param_hi, param_lo, 
-							tag, tef, deadline_hi, deadline_lo, executed_hi, executed_lo;
+		uint64_t valid = actionCount - countBefore;
+
+		// Pop all actions that were counted since the last MSI, not only one.
+		// If there is one MSI per action, the MSIs of actions that were 
+		// already popped have nothing left to do.
+		unsigned pops = 1;
+		if (valid > 0) {
+			pops = std::min<uint64_t>(valid, std::max<unsigned>(capacity, 1));
+			// Hardware may coalesce MSIs, so not every popped entry gets its own MSI later.
+			// There can't be more outstanding MSIs than entries in the queue.
+			drainedAhead = std::min<unsigned>(drainedAhead + pops-1, capacity);
+		} else if (drainedAhead > 0) {
+			--drainedAhead;
+			return;
+		}
+
+		struct QueueEntry {
+			eb_data_t flags, rawNum, event_hi, event_lo, param_hi, param_lo, 
+			          tag, tef, deadline_hi, deadline_lo, executed_hi, executed_lo;
+		};
+		std::vector<QueueEntry> entries(pops);
 		
 		// std::cerr << "read data" << std::endl;
 		etherbone::Cycle cycle;
-		cycle.open(eca.get_device());
-		cycle.read(queue + ECA_QUEUE_FLAGS_GET,       EB_DATA32, &flags);
-		cycle.read(queue + ECA_QUEUE_NUM_GET,         EB_DATA32, &rawNum);
-		cycle.read(queue + ECA_QUEUE_EVENT_ID_HI_GET, EB_DATA32, &event_hi);
-		cycle.read(queue + ECA_QUEUE_EVENT_ID_LO_GET, EB_DATA32, &event_lo);
-		cycle.read(queue + ECA_QUEUE_PARAM_HI_GET,    EB_DATA32, &param_hi);
-		cycle.read(queue + ECA_QUEUE_PARAM_LO_GET,    EB_DATA32, &param_lo);
-		cycle.read(queue + ECA_QUEUE_TAG_GET,         EB_DATA32, &tag);
-		cycle.read(queue + ECA_QUEUE_TEF_GET,         EB_DATA32, &tef);
-		cycle.read(queue + ECA_QUEUE_DEADLINE_HI_GET, EB_DATA32, &deadline_hi);
-		cycle.read(queue + ECA_QUEUE_DEADLINE_LO_GET, EB_DATA32, &deadline_lo);
-		cycle.read(queue + ECA_QUEUE_EXECUTED_HI_GET, EB_DATA32, &executed_hi);
-		cycle.read(queue + ECA_QUEUE_EXECUTED_LO_GET, EB_DATA32, &executed_lo);
-		cycle.write(queue + ECA_QUEUE_POP_OWR, EB_DATA32, 1);
+		for (unsigned i = 0; i < pops; ++i) {
+			if (i % max_pops_per_cycle == 0) {
+				if (i > 0) cycle.close();
+				cycle.open(eca.get_device());
+			}
+			QueueEntry &e = entries[i];
+			cycle.read(queue + ECA_QUEUE_FLAGS_GET,       EB_DATA32, &e.flags);
+			cycle.read(queue + ECA_QUEUE_NUM_GET,         EB_DATA32, &e.rawNum);
+			cycle.read(queue + ECA_QUEUE_EVENT_ID_HI_GET, EB_DATA32, &e.event_hi);
+			cycle.read(queue + ECA_QUEUE_EVENT_ID_LO_GET, EB_DATA32, &e.event_lo);
+			cycle.read(queue + ECA_QUEUE_PARAM_HI_GET,    EB_DATA32, &e.param_hi);
+			cycle.read(queue + ECA_QUEUE_PARAM_LO_GET,    EB_DATA32, &e.param_lo);
+			cycle.read(queue + ECA_QUEUE_TAG_GET,         EB_DATA32, &e.tag);
+			cycle.read(queue + ECA_QUEUE_TEF_GET,         EB_DATA32, &e.tef);
+			cycle.read(queue + ECA_QUEUE_DEADLINE_HI_GET, EB_DATA32, &e.deadline_hi);
+			cycle.read(queue + ECA_QUEUE_DEADLINE_LO_GET, EB_DATA32, &e.deadline_lo);
+			cycle.read(queue + ECA_QUEUE_EXECUTED_HI_GET, EB_DATA32, &e.executed_hi);
+			cycle.read(queue + ECA_QUEUE_EXECUTED_LO_GET, EB_DATA32, &e.executed_lo);
+			cycle.write(queue + ECA_QUEUE_POP_OWR, EB_DATA32, 1);
+		}
 		cycle.close();
 		// std::cerr << "read done" << std::endl;
 		
-		uint64_t id       = uint64_t(event_hi)    << 32 | event_lo;
-		uint64_t param    = uint64_t(param_hi)    << 32 | param_lo;
-		uint64_t deadline = uint64_t(deadline_hi) << 32 | deadline_lo;
-		uint64_t executed = uint64_t(executed_hi) << 32 | executed_lo;
-		
-		if ((flags & (1<<ECA_VALID)) == 0) {
-			std::cerr << "SoftwareActionSink: MSI for increase in VALID_COUNT did not correspond to a valid action in the queue" << std::endl;
-			return;
+		std::vector<SoftwareCondition*> drained;
+		for (auto &e: entries) {
+			uint64_t id       = uint64_t(e.event_hi)    << 32 | e.event_lo;
+			uint64_t param    = uint64_t(e.param_hi)    << 32 | e.param_lo;
+			uint64_t deadline = uint64_t(e.deadline_hi) << 32 | e.deadline_lo;
+			uint64_t executed = uint64_t(e.executed_hi) << 32 | e.executed_lo;
+			
+			if ((e.flags & (1<<ECA_VALID)) == 0) {
+				std::cerr << "SoftwareActionSink: MSI for increase in VALID_COUNT did not correspond to a valid action in the queue" << std::endl;
+				drainedAhead = 0; // no MSI of an already popped entry is outstanding
+				break; // the queue is empty
+			}
+			
+			if (e.rawNum != num) {
+				std::cerr << "SoftwareActionSink: MSI dispatched to wrong queue" << std::endl;
+				continue;
+			}
+			
+			// Emit the Action
+			Conditions::iterator it = conditions.find(e.tag);
+			if (it == conditions.end()) {
+				// This can happen if the user deletes a condition at the same time a match arrives
+				// => Just silently discard the action on this race condition
+				continue;
+			} 
+			
+			if (!it->second) {
+				std::cerr << "SoftwareActionSink: a Condition was not a SoftwareCondition" << std::endl;
+				continue;
+			}
+			
+			// DRIVER_LOG("deadline",-1, deadline);
+			// DRIVER_LOG("id",      -1, id);
+			// Inform clients
+			// softwareCondition->Action(id, param, deadline, executed, flags & 0xF);
+			// std::cerr << "cast" << std::endl;
+			Condition* cond = it->second.get();
+			SoftwareCondition* sw_cond = dynamic_cast<SoftwareCondition*>(cond);
+			// std::cerr << "SigAction" << std::endl;
+			sw_cond->action(id, param, deadline, executed, e.flags & 0xF);
+			if (drained.empty() || drained.back() != sw_cond) {
+				drained.push_back(sw_cond);
+			}
 		}
-		
-		if (rawNum != num) {
-			std::cerr << "SoftwareActionSink: MSI dispatched to wrong queue" << std::endl;
-			return;
-		}
-		
-		// Emit the Action
-		Conditions::iterator it = conditions.find(tag);
-		if (it == conditions.end()) {
-			// This can happen if the user deletes a condition at the same time a match arrives
-			// => Just silently discard the action on this race condition
-			return;
-		} 
-		
-		if (!it->second) {
-			std::cerr << "SoftwareActionSink: a Condition was not a SoftwareCondition" << std::endl;
-			return;
+		// conditions without batch latency emit their batch now
+		for (auto sw_cond: drained) {
+			sw_cond->queueDrained();
 		}
 		
-		// DRIVER_LOG("deadline",-1, deadline);
-		// DRIVER_LOG("id",      -1, id);
-		// Inform clients
-		// softwareCondition->Action(id, param, deadline, executed, flags & 0xF);
-		// std::cerr << "cast" << std::endl;
-		Condition* cond = it->second.get();
-		SoftwareCondition* sw_cond = dynamic_cast<SoftwareCondition*>(cond);
-		// std::cerr << "SigAction" << std::endl;
-		sw_cond->SigAction(id, param, saftlib::makeTimeTAI(deadline), saftlib::makeTimeTAI(executed), flags & 0xF);
-		
 	} else {
 		// std::cerr << "not ECA_VALID" << std::endl;
 		// DRIVER_LOG("MSI-ECA_NOT_VALID",-1, code);
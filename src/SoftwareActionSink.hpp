@@ -81,6 +81,7 @@ namespace saftlib {
 		
 	protected:
 		eb_address_t queue;
+		unsigned drainedAhead; // number of queue entries that were popped before their MSI arrived
 	};
 
 }
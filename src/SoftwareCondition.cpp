@@ -26,12 +26,93 @@
 
 #include "SoftwareCondition.hpp"
 
+#include <functional>
+
 namespace saftlib {
 
 SoftwareCondition::SoftwareCondition(ActionSink *sink, unsigned number, bool active, uint64_t id, uint64_t mask, int64_t offset, saftbus::Container *container = nullptr)
- : Condition(sink, number, active, id, mask, offset, number, container)
+ : Condition(sink, number, active, id, mask, offset, number, container), batchSize(0), batchLatency(1000000)
 {
   // std::cerr << "SoftwareCondition::SoftwareCondition()" << std::endl;
 }
 
+SoftwareCondition::~SoftwareCondition()
+{
+  // actions that are still in the batch are lost, nobody can receive them anymore
+  saftbus::Loop::get_default().remove(batchTimeout);
+}
+
+uint32_t SoftwareCondition::getBatchSize() const
+{
+  return batchSize;
+}
+
+void SoftwareCondition::setBatchSize(uint32_t val)
+{
+  batchSize = val;
+  // don't keep actions longer than the new size allows
+  if (!batch.empty() && batch.size() >= batchSize) flushActions();
+}
+
+uint64_t SoftwareCondition::getBatchLatency() const
+{
+  return batchLatency.count();
+}
+
+void SoftwareCondition::setBatchLatency(uint64_t val)
+{
+  batchLatency = std::chrono::nanoseconds(val);
+  // a waiting batch would still use the old latency
+  if (!batch.empty()) flushActions();
+}
+
+void SoftwareCondition::action(uint64_t event, uint64_t param, uint64_t deadline, uint64_t executed, uint16_t flags)
+{
+  if (batchSize == 0) {
+    SigAction(event, param, saftlib::makeTimeTAI(deadline), saftlib::makeTimeTAI(executed), flags);
+    return;
+  }
+  ActionRecord record = {};
+  record.event    = event;
+  record.param    = param;
+  record.deadline = deadline;
+  record.executed = executed;
+  record.flags    = flags;
+  batch.push_back(record);
+  if (batch.size() >= batchSize) {
+    flushActions();
+  } else if (batch.size() == 1 && batchLatency.count() > 0) {
+    // the latency window starts with the first action of the batch
+    // the timer resolution is 1us, round up (a 0us interval would mean 1ms for TimeoutSource)
+    std::chrono::microseconds interval = std::chrono::duration_cast<std::chrono::microseconds>(batchLatency);
+    if (interval < batchLatency) ++interval;
+    batchTimeout = saftbus::Loop::get_default().connect<saftbus::TimeoutSource>(
+      std::bind(&SoftwareCondition::batchLatencyExpired, this), interval, interval);
+  }
+}
+
+void SoftwareCondition::queueDrained()
+{
+  if (batchLatency.count() == 0 && !batch.empty()) flushActions();
+}
+
+void SoftwareCondition::flushActions()
+{
+  saftbus::Loop::get_default().remove(batchTimeout);
+  if (!batch.empty()) {
+    SigActions(batch);
+    batch.clear();
+  }
+}
+
+bool SoftwareCondition::batchLatencyExpired()
+{
+  batchTimeout = saftbus::SourceHandle(); // returning false removes the source from the loop
+  if (!batch.empty()) {
+    SigActions(batch);
+    batch.clear();
+  }
+  return false;
+}
+
 }
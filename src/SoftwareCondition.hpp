@@ -29,12 +29,17 @@
 // @saftbus-include
 #include <Time.hpp>
 // @saftbus-include
+#include <ActionRecord.hpp>
+// @saftbus-include
 #include <sigc++/sigc++.h>
 
 #include <saftbus/service.hpp>
+#include <saftbus/loop.hpp>
 
 
 #include <functional>
+#include <vector>
+#include <chrono>
 
 namespace saftlib {
 
@@ -50,6 +55,7 @@ class SoftwareCondition : public Condition
 {
 public:
 	SoftwareCondition(ActionSink *sink, unsigned number, bool active, uint64_t id, uint64_t mask, int64_t offset, saftbus::Container *container);
+	~SoftwareCondition();
 
 	/// @brief    Emitted whenever the condition matches a timing event.
 	/// 
@@ -72,10 +78,60 @@ public:
 	// @saftbus-export
 	sigc::signal<void, uint64_t, uint64_t, saftlib::Time, saftlib::Time, uint16_t > SigAction;
 
+	/// @brief    Emitted with a batch of actions if BatchSize is not 0.
+	///
+	/// @param actions  The actions in the order in which they were executed.
+	///
+	/// If BatchSize is not 0, matching actions are collected and delivered
+	/// with this signal instead of SigAction. A batch is emitted when it holds
+	/// BatchSize actions or when its first action waited for BatchLatency.
+	/// High rates of actions need only one saftbus message per batch this way.
+	/// The same accept rules apply as for SigAction.
+	///
+	// @saftbus-export
+	sigc::signal<void, std::vector<saftlib::ActionRecord> > SigActions;
+
+	/// @brief  Maximum number of actions in one SigActions signal (default 0).
+	/// @return Maximum number of actions in one SigActions signal (default 0).
+	///
+	/// If BatchSize is 0, every action is emitted with SigAction.
+	/// Otherwise all actions are emitted with SigActions.
+	///
+	// @saftbus-export
+	uint32_t getBatchSize() const;
+	// @saftbus-export
+	void setBatchSize(uint32_t val);
+
+	/// @brief  Maximum delay of an action before its batch is emitted (nanoseconds, default 1ms).
+	/// @return Maximum delay of an action before its batch is emitted (nanoseconds, default 1ms).
+	///
+	/// If BatchLatency is 0, a batch is emitted as soon as all actions
+	/// that were in the hardware queue of the SoftwareActionSink were read.
+	/// Other values are rounded up to full microseconds.
+	///
+	// @saftbus-export
+	uint64_t getBatchLatency() const;
+	// @saftbus-export
+	void setBatchLatency(uint64_t val);
+
+	// used by SoftwareActionSink to deliver an action to SigAction or SigActions
+	void action(uint64_t event, uint64_t param, uint64_t deadline, uint64_t executed, uint16_t flags);
+	// used by SoftwareActionSink after all actions of one MSI are delivered
+	void queueDrained();
+
 	// // @saftbus-export
 	// std::function< void(uint64_t event, uint64_t param, saftlib::Time deadline, saftlib::Time executed, uint16_t flags) > Action;
 
 	typedef SoftwareCondition_Service ServiceType;
+
+protected:
+	void flushActions();
+	bool batchLatencyExpired();
+
+	uint32_t batchSize;
+	std::chrono::nanoseconds batchLatency;
+	std::vector<ActionRecord> batch;
+	saftbus::SourceHandle batchTimeout;
 };
 
 }
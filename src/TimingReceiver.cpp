@@ -43,8 +43,8 @@
 
 namespace saftlib {
 
-TimingReceiver::TimingReceiver(SAFTd &saftd, const std::string &n, const std::string &eb_path, int polling_interval_ms, saftbus::Container *cont)
-	: OpenDevice(saftd.get_etherbone_socket(), eb_path, polling_interval_ms, &saftd)
+TimingReceiver::TimingReceiver(SAFTd &saftd, const std::string &n, const std::string &eb_path, std::chrono::microseconds polling_interval, saftbus::Container *cont, std::chrono::microseconds max_polling_interval)
+	: OpenDevice(saftd.get_etherbone_socket(), eb_path, polling_interval, &saftd, max_polling_interval)
 	, Watchdog(OpenDevice::device)
 	, WhiteRabbit(OpenDevice::device)
 	, ECA(saftd, OpenDevice::device, saftd.getObjectPath() + "/" + n, cont)
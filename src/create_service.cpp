@@ -47,8 +47,9 @@ void destroy_service() {
 /// @param saftd a pointer to a SAFTd
 /// @param name logical saftlib name. For example tr0, tr1 or tr*
 /// @param etherbone_path etherbone path. If name has a '*' as last character, etherbone_path needs '*' as last character, too.
-/// @param poll_interval_ms this is directly passed to AttachDevice function
-void handle_wildcards_and_attach_device(saftlib::SAFTd *saftd, const std::string name, const std::string etherbone_path, int poll_interval_ms) {
+/// @param poll_interval this is directly passed to AttachDevice function
+/// @param max_poll_interval this is directly passed to AttachDevice function
+void handle_wildcards_and_attach_device(saftlib::SAFTd *saftd, const std::string name, const std::string etherbone_path, std::chrono::microseconds poll_interval, std::chrono::microseconds max_poll_interval) {
 	if (name.size() && name.back() == '*') {
 		if (etherbone_path.size() && etherbone_path.back() != '*') {
 			throw saftbus::Error(saftbus::Error::INVALID_ARGS, "if name has * wildcard as last char, etherbone_path also needs wildcard as last char");
@@ -74,7 +75,7 @@ void handle_wildcards_and_attach_device(saftlib::SAFTd *saftd, const std::string
 
 						std::cerr << "found name device pair "  << new_name << ":" << new_path << std::endl;
 						found_one = true;
-						saftd->AttachDevice(new_name, new_path, poll_interval_ms);
+						saftd->AttachDevice(new_name, new_path, poll_interval, max_poll_interval);
 					}
 				}
 				if (!found_one) {
@@ -90,10 +91,29 @@ void handle_wildcards_and_attach_device(saftlib::SAFTd *saftd, const std::string
 			throw saftbus::Error(saftbus::Error::INVALID_ARGS, msg.str());
 		}
 	} else {
-		saftd->AttachDevice(name, etherbone_path, poll_interval_ms);
+		saftd->AttachDevice(name, etherbone_path, poll_interval, max_poll_interval);
 	}
 }
 
+/// @brief read a poll interval in milliseconds, or in microseconds if it has the suffix "us" (e.g. 250us)
+/// @return false if the string is not a valid poll interval
+static bool parse_poll_interval(const std::string &str, std::chrono::microseconds &poll_interval) {
+	std::istringstream in(str);
+	int value = 0;
+	std::string unit;
+	in >> value;
+	bool valid_value = in && value > 0;
+	in >> unit; // optional, stays empty if there is no unit
+	if (!valid_value || (unit != "" && unit != "us" && unit != "ms")) {
+		return false;
+	}
+	poll_interval = std::chrono::milliseconds(value);
+	if (unit == "us") {
+		poll_interval = std::chrono::microseconds(value);
+	}
+	return true;
+}
+
 
 
 extern "C" 
@@ -116,26 +136,33 @@ void create_services(saftbus::Container *container, const std::vector<std::strin
 	for (auto &arg: args) {
 		size_t pos = arg.find(':'); // the position of the first colon ':'
 		if (pos == arg.npos || pos+1 == arg.size()) {
-			throw std::runtime_error("expect <name>:<eb-path>[:<poll-interval>] as argument");
+			throw std::runtime_error("expect <name>:<eb-path>[:<poll-interval>[-<max-poll-interval>]] as argument");
 		}
 		std::string name = arg.substr(0, pos);
 		std::string path = arg.substr(pos+1);
-		int poll_interval_ms = 1;
+		// the poll interval is in milliseconds, or in microseconds if it has the suffix "us" (e.g. tr0:dev/ttyUSB0:250us).
+		// With a range of poll intervals, the interval adapts to the MSI rate (e.g. tr0:dev/ttyUSB0:250us-20ms).
+		std::chrono::microseconds poll_interval = std::chrono::milliseconds(1);
+		std::chrono::microseconds max_poll_interval(0);
 		size_t pos2 = path.find(':'); // the position of the second colon ':'
 		if (pos2 != path.npos) {
 			if (pos2+1 == path.size()) { // 2nd colon is there, but poll inteval is missing
-				throw std::runtime_error("expect <name>:<eb-path>[:<poll-interval>] as argument");
+				throw std::runtime_error("expect <name>:<eb-path>[:<poll-interval>[-<max-poll-interval>]] as argument");
 			} 
-			std::istringstream poll_interval(path.substr(pos2+1));
-			poll_interval >> poll_interval_ms;
-			if (!poll_interval || poll_interval_ms <= 0) {
+			std::string intervals = path.substr(pos2+1);
+			size_t dash = intervals.find('-');
+			bool valid = parse_poll_interval(intervals.substr(0,dash), poll_interval);
+			if (valid && dash != intervals.npos) {
+				valid = parse_poll_interval(intervals.substr(dash+1), max_poll_interval) && max_poll_interval >= poll_interval;
+			}
+			if (!valid) {
 				std::ostringstream msg;
-				msg << "cannot read poll interval from \'" << path.substr(pos2+1) << "\' after " << name << ":" << path << ":";
+				msg << "cannot read poll interval from \'" << intervals << "\' after " << name << ":" << path << ":";
 				throw std::runtime_error(msg.str());
 			}
 			path = path.substr(0,pos2);
 		}
-		handle_wildcards_and_attach_device(saftd.get(), name, path, poll_interval_ms);
+		handle_wildcards_and_attach_device(saftd.get(), name, path, poll_interval, max_poll_interval);
 	}
 }
 
@@ -24,24 +24,56 @@
 
 #include <sys/stat.h>
 #include <fcntl.h>
-#include <termios.h>
-#include <fcntl.h>
 #include <unistd.h>
 #include <poll.h>
 
 #include <iostream>
-#include <iomanip>
 #include <functional>
+#include <cerrno>
 
 #define WR_PPS_VENDOR_ID        0xce42
 #define WR_PPS_DEVICE_ID        0xde0d8ced
-#define WR_PPS_GEN_ESCR         0x1c      //External Sync Control Register
+
+// flags in the first byte of an etherbone record header
+#define EB_RECORD_BCA 0x80 // base (return) address is in config space
+#define EB_RECORD_RCA 0x40 // read addresses are in config space
+#define EB_RECORD_RFF 0x20 // read back to a fifo
+#define EB_RECORD_CYC 0x08 // drop the cycle line after this record
+#define EB_RECORD_WCA 0x04 // write addresses are in config space
+#define EB_RECORD_WFF 0x02 // write to a fifo
 
 namespace saftlib {
 
+	static uint32_t get_be32(const uint8_t *ptr)
+	{
+		return (uint32_t)ptr[0] << 24 | (uint32_t)ptr[1] << 16 | (uint32_t)ptr[2] << 8 | (uint32_t)ptr[3];
+	}
+	static void put_be32(std::vector<uint8_t> &buffer, uint32_t value)
+	{
+		buffer.push_back(value >> 24);
+		buffer.push_back(value >> 16);
+		buffer.push_back(value >>  8);
+		buffer.push_back(value);
+	}
+	// Width and position of the accesses of a record on the 32 bit bus.
+	// Returns false if the byte enable doesn't select a contiguous, naturally aligned group of byte lanes.
+	static bool decode_byte_enable(uint8_t byte_enable, eb_format_t &width, uint8_t &shift)
+	{
+		switch (byte_enable) {
+			case 0x0f: width = EB_DATA32; shift =  0; return true;
+			case 0x03: width = EB_DATA16; shift =  0; return true;
+			case 0x0c: width = EB_DATA16; shift = 16; return true;
+			case 0x01: width = EB_DATA8;  shift =  0; return true;
+			case 0x02: width = EB_DATA8;  shift =  8; return true;
+			case 0x04: width = EB_DATA8;  shift = 16; return true;
+			case 0x08: width = EB_DATA8;  shift = 24; return true;
+		}
+		return false;
+	}
+
 	void EB_Forward::open_pts() 
 	{
-		_pts_fd = open("/dev/ptmx", O_RDWR);
+		_pts_fd = open("/dev/ptmx", O_RDWR | O_NOCTTY | O_NONBLOCK);
 		grantpt(_pts_fd);
 		unlockpt(_pts_fd);
 		chmod(ptsname(_pts_fd), S_IRUSR | S_IWUSR | 
@@ -49,189 +81,282 @@ namespace saftlib {
 			                    S_IROTH | S_IWOTH );
 
 		// std::cerr << "eb-forward " << eb_forward_path() << std::endl;
-		io_source = saftbus::Loop::get_default().connect<saftbus::IoSource>(std::bind(&EB_Forward::accept_connection, this, std::placeholders::_1), _pts_fd, POLLIN);
+		io_source = saftbus::Loop::get_default().connect<saftbus::IoSource>(std::bind(&EB_Forward::pts_readable, this, std::placeholders::_1, std::placeholders::_2), _pts_fd, POLLIN);
 	}
 
-	EB_Forward::EB_Forward(const std::string& eb_name, etherbone::Device &device)
-		: SdbDevice(device, WR_PPS_VENDOR_ID, WR_PPS_DEVICE_ID)
-	{	
-		_pts_fd = 0;
-		if (eb_name.size()) {
-			if (eb_name[0] == '/') {
-				_eb_device_fd = open(eb_name.c_str(), O_RDWR);
-			} else {
-				std::string name = "/";
-				name.append(eb_name);
-				_eb_device_fd = open(name.c_str(), O_RDWR);
-			}
-			if (_eb_device_fd > 0) {
-				open_pts();
-				return;
+	// The eb-tool is gone: forget everything that belongs to it and wait for the next one.
+	// Only called from pts_readable, which removes its IoSource by returning false.
+	void EB_Forward::reset_pts()
+	{
+		close(_pts_fd); 
+		release_transactions();
+		input.clear();
+		output.clear();
+		saftbus::Loop::get_default().remove(out_source);
+		out_source = saftbus::SourceHandle();
+		open_pts();
+	}
+
+	// Transactions with a cycle in flight are handed over to cycle_done, which deletes them.
+	void EB_Forward::release_transactions()
+	{
+		for (auto &transaction: transactions) {
+			if (transaction->cycle_open && !transaction->closed) {
+				transaction->cycle.abort();
+			} else if (transaction->cycle_open && !transaction->done) {
+				transaction->forward = nullptr;
+				transaction.release();
 			}
 		}
+		transactions.clear();
+	}
+
+	EB_Forward::EB_Forward(const std::string& /* eb_name: the device is accessed through etherbone only */, etherbone::Device &device)
+		: SdbDevice(device, WR_PPS_VENDOR_ID, WR_PPS_DEVICE_ID)
+	{	
 		open_pts();
 	} 
 	EB_Forward::~EB_Forward()
 	{
 		saftbus::Loop::get_default().remove(io_source);
-		close(_eb_device_fd);
-		if (_pts_fd) {
-			close(_pts_fd);
-		}		
+		saftbus::Loop::get_default().remove(out_source);
+		release_transactions();
+		close(_pts_fd);
 	}
 
-	bool EB_Forward::accept_connection(int condition)
+	bool EB_Forward::pts_readable(int fd, int condition)
 	{
-		// std::cerr << "EB_Forward::accept_connection" << std::endl;
-		// static std::vector<uint8_t> request;  // data from eb-tool
-		// static std::vector<uint8_t> response; // data from device
-		request.clear();
-		response.clear();
+		uint8_t buffer[4096];
+		for (;;) {
+			ssize_t result = read(_pts_fd, buffer, sizeof(buffer));
+			if (result > 0) {
+				input.insert(input.end(), buffer, buffer+result);
+				continue;
+			}
+			if (result < 0 && errno == EINTR) {
+				continue;
+			}
+			if (result < 0 && errno == EAGAIN) {
+				break;
+			}
+			// end of file or error: the eb-tool closed the pseudo-terminal
+			reset_pts();  // close and reopen immediately
+			return false; // remove old fd from loop
+		}
 
-		unsigned request_size = 0;
+		size_t consumed = parse_input();
+		input.erase(input.begin(), input.begin()+consumed);
+		send_responses(); // transactions without operations are already done
+		return true;
+	}
 
-		for (;;) {
-			uint8_t val;
-			int result = read(_pts_fd, (void*)&val, sizeof(val));
-			if (result <= 0) { // end of file 
-				close(_pts_fd); // close and reopen immediately
-				open_pts(); 
-				return false; // remove old fd from loop
-			}
-			if (result == sizeof(val)) { // normal read 
-				request.push_back(val);
-
-				if (request.size() == 4) {
-					if ( request[0]     == 0x4e  // test for Etherbone magic word
-					  && request[1]     == 0x6f 
-					  )//&& request[2]     == 0x11 
-					   //&& (request[3]     == 0xff || request[3] == 0x77)) // on 32 bit systems, the host will send 0x77 while on 64 bit systems the host will send 0xff
-					{
-						// hard-coded response
-						response.push_back(0x4e);
-						response.push_back(0x6f);
-						response.push_back(0x16);
-						response.push_back(0x44);
-
-						for (int i = 0; i < 4; ++i) {
-							result = read(_pts_fd, (void*)&val, sizeof(val));
-							if (result <= 0) { 
-								close(_pts_fd); // close and reopen immediately
-								open_pts(); 
-								return false; // remove old fd from loop
-							}
-							response.push_back(val);
-						}
-						result = write(_pts_fd, (void*)&response[0], response.size());
-						if (result <= 0) { 
-							close(_pts_fd); // close and reopen immediately
-							open_pts(); 
-							return false; // remove old fd from loop
-						}
-						// handling of Etherbone header done.
-						return true;
-					} else { // assume it is an Etherbone cycle header, calculate the response size
-						int wcount = request[2];
-						int rcount = request[3];
-						request_size += 4; // for the cycle header
-						if (wcount) {
-							request_size += 4 + 4*wcount; // base address + wcount write values 
-						}
-						if (rcount) {
-							request_size += 4 + 4*rcount; // base return address + rcount read addresses
-						}
-					}
+	// split the input into the etherbone probe and records, return the number of processed bytes
+	size_t EB_Forward::parse_input()
+	{
+		size_t pos = 0;
+		bool flush = false;
+		while (input.size()-pos >= 4) {
+			const uint8_t *header = &input[pos];
+			if (header[0] == 0x4e && header[1] == 0x6f) { // test for Etherbone magic word
+				if (input.size()-pos < 8) {
+					break;
 				}
+				// hard-coded response. It goes through the transaction queue to keep its place among the responses
+				if (transactions.empty() || transactions.back()->closed) {
+					std::unique_ptr<Transaction> probe(new Transaction(this));
+					probe->raw_response.insert(probe->raw_response.end(), {0x4e, 0x6f, 0x16, 0x44});
+					probe->raw_response.insert(probe->raw_response.end(), header+4, header+8);
+					probe->closed = true;
+					probe->done   = true;
+					transactions.push_back(std::move(probe));
+				} else {
+					std::cerr << "EB_Forward: etherbone probe inside of a cycle ignored" << std::endl;
+				}
+				pos += 8;
+				continue;
+			}
+			// assume it is an Etherbone record header, calculate the record size
+			int wcount = header[2];
+			int rcount = header[3];
+			size_t size = 4; // for the record header
+			if (wcount) {
+				size += 4 + 4*wcount; // base address + wcount write values 
+			}
+			if (rcount) {
+				size += 4 + 4*rcount; // base return address + rcount read addresses
+			}
+			if (input.size()-pos < size) {
+				break;
+			}
+			add_record(header, size);
+			if (header[0] & EB_RECORD_CYC) {
+				flush = true;
+			}
+			pos += size;
+		}
+		if (flush) {
+			device.flush();
+		}
+		return pos;
+	}
 
-				// process the request by sending it to the device,
-				//  read the response from the device and write the 
-				//   response back to the eb-tool
-				if (request_size && request_size == request.size()) {
-					// std::cerr << _eb_device_fd << " " << _pts_fd << " request_size = " << request.size() << std::endl;
-					// all cycle bytes read
-
-					// visu.clear();
-					// for (int i = 0; i < (int)request.size()/4; ++i) {
-					// 	std::ostringstream req_out;
-					// 	for (int j = 0; j < 4; ++j) {
-					// 		req_out << std::hex << std::setw(2) << std::setfill('0') << (int)request[i*4+j];
-					// 	}
-					// 	visu.push_back(std::make_pair(req_out.str(),""));
-					// }
-
-
-					write_all(_eb_device_fd, (char*)&request[0], request.size());
-					response.clear();
-					response.resize(request.size());
-					struct pollfd pfds[1] = {0,};
-					pfds[0].fd = _eb_device_fd;
-					pfds[0].events = POLLIN | POLLHUP;
-					if (poll(pfds,1,-1) == 0) {
-						return false;
-					}
-					read_all(_eb_device_fd, (char*)&response[0], response.size());
-
-					// for (int i = 0; i < (int)response.size()/4; ++i) {
-					// 	std::ostringstream resp_out;
-					// 	for (int j = 0; j < 4; ++j) {
-					// 		resp_out << std::hex << std::setw(2) << std::setfill('0') << (int)response[i*4+j];
-					// 	}
-					// 	visu[i].second = resp_out.str();
-					// }
+	// add the operations of a complete record to the current cycle
+	void EB_Forward::add_record(const uint8_t *header, size_t size)
+	{
+		if (transactions.empty() || transactions.back()->closed) {
+			transactions.push_back(std::unique_ptr<Transaction>(new Transaction(this)));
+		}
+		Transaction &transaction = *transactions.back();
 
-					// std::cout << "---" << std::endl;
-					// for(auto &line: visu) {
-					// 	std::cout << line.first << "   " << line.second << std::endl;
-					// }
+		Record record;
+		record.flags       = header[0];
+		record.byte_enable = header[1];
+		record.shift       = 0;
+		record.rcount      = header[3];
+		record.return_base = 0;
+		record.size        = size;
+		int wcount         = header[2];
 
+		// The forwarded device is 32 bit wide. Partial word accesses are forwarded as 8 or 16 bit 
+		// accesses to the selected bytes (big endian, the byte with the lowest address is in bits 31..24).
+		eb_format_t width = EB_DATA32;
+		bool supported = decode_byte_enable(record.byte_enable, width, record.shift);
+		eb_address_t lane_offset = 4 - width - record.shift/8;
+		eb_format_t format = width | EB_BIG_ENDIAN;
+		if (!supported && (wcount || record.rcount)) {
+			std::cerr << "EB_Forward: byte enable 0x" << std::hex << (int)record.byte_enable << std::dec 
+			          << " not supported, record skipped" << std::endl;
+		}
+		if (supported && !transaction.cycle_open && (wcount || record.rcount)) {
+			transaction.cycle.open(device, &transaction, &EB_Forward::cycle_done);
+			transaction.cycle_open = true;
+		}
 
-					write_all(_pts_fd, (char*)&response[0], response.size());
+		const uint8_t *ptr = header+4;
+		if (wcount) {
+			uint32_t base = get_be32(ptr);
+			ptr += 4;
+			for (int i = 0; i < wcount; ++i, ptr += 4) {
+				if (!supported) {
+					continue;
+				}
+				eb_address_t address = (((record.flags & EB_RECORD_WFF) ? base : base + 4*i) & ~eb_address_t(3)) + lane_offset;
+				eb_data_t    value   = (get_be32(ptr) >> record.shift) & ((eb_data_t(1) << (8*width)) - 1);
+				if (record.flags & EB_RECORD_WCA) {
+					transaction.cycle.write_config(address, format, value);
+				} else {
+					transaction.cycle.write(address, format, value);
+				}
+			}
+		}
+		if (record.rcount) {
+			record.return_base = get_be32(ptr);
+			ptr += 4;
+			for (int i = 0; i < record.rcount; ++i, ptr += 4) {
+				transaction.data.push_back(0);
+				if (!supported) {
+					continue;
+				}
+				eb_address_t address = (get_be32(ptr) & ~eb_address_t(3)) + lane_offset;
+				if (record.flags & EB_RECORD_RCA) {
+					transaction.cycle.read_config(address, format, &transaction.data.back());
+				} else {
+					transaction.cycle.read(address, format, &transaction.data.back());
+				}
+			}
+		}
+		transaction.records.push_back(record);
 
-					// just read once after the forwarding procedure ... maybe this fixes the occasional wrong read
-					eb_data_t data;
-					device.read(adr_first + WR_PPS_GEN_ESCR, EB_DATA32, &data);
+		if (record.flags & EB_RECORD_CYC) {
+			transaction.closed = true;
+			if (transaction.cycle_open) {
+				transaction.cycle.close(); // cycle_done is called when the device responds
+			} else {
+				transaction.done = true;
+			}
+		}
+	}
 
+	void EB_Forward::cycle_done(Transaction *transaction, etherbone::Device dev, etherbone::Operation op, etherbone::status_t status)
+	{
+		transaction->done   = true;
+		transaction->status = status;
+		if (transaction->forward == nullptr) { // nobody is waiting for the response
+			delete transaction;
+			return;
+		}
+		transaction->forward->send_responses();
+	}
 
-					return true;
+	// turn all completed transactions at the front of the queue into response records
+	void EB_Forward::send_responses()
+	{
+		while (!transactions.empty() && transactions.front()->done) {
+			Transaction &transaction = *transactions.front();
+			size_t n = 0;
+			for (auto &record: transaction.records) {
+				size_t start = output.size();
+				if (record.rcount) {
+					// the response is a write of the read values to the return address
+					output.push_back(((record.flags & EB_RECORD_BCA) ? EB_RECORD_WCA : 0) 
+					               | ((record.flags & EB_RECORD_RFF) ? EB_RECORD_WFF : 0) 
+					               |  (record.flags & EB_RECORD_CYC));
+					output.push_back(record.byte_enable);
+					output.push_back(record.rcount);
+					output.push_back(0);
+					put_be32(output, record.return_base);
+					for (int i = 0; i < record.rcount; ++i, ++n) {
+						put_be32(output, transaction.status == EB_OK ? transaction.data[n] << record.shift : 0);
+					}
 				}
-
+				output.resize(start + record.size, 0); // pad the response to the size of the request
+			}
+			output.insert(output.end(), transaction.raw_response.begin(), transaction.raw_response.end());
+			if (transaction.status != EB_OK) {
+				std::cerr << "EB_Forward: forwarded cycle failed: " << eb_status(transaction.status) << std::endl;
 			}
+			transactions.pop_front();
 		}
-		return false;
-	}	
+		flush_output();
+	}
 
-	void EB_Forward::write_all(int fd, char *ptr, int size) 
+	// write as much output as possible without blocking, the rest is written when the pts becomes writable
+	void EB_Forward::flush_output()
 	{
-		while (size > 0) {
-			int result = write(fd, ptr, size);
+		size_t written = 0;
+		while (written < output.size()) {
+			ssize_t result = write(_pts_fd, &output[written], output.size()-written);
 			if (result > 0) {
-				size -= result;
-				ptr += result;
-			} else {
-				std::cerr << "EB_Forward::write_all failed" << std::endl;
-				// error... very bad... dont know how to handle this 
-				// this probably means that the device is not connected anymore
-				return;
+				written += result;
+				continue;
 			}
+			if (result < 0 && errno == EINTR) {
+				continue;
+			}
+			if (result < 0 && errno == EAGAIN) {
+				if (!out_source.connected()) {
+					out_source = saftbus::Loop::get_default().connect<saftbus::IoSource>(std::bind(&EB_Forward::pts_writable, this, std::placeholders::_1, std::placeholders::_2), _pts_fd, POLLOUT);
+				}
+				break;
+			}
+			// the eb-tool is gone, pts_readable will notice and reopen the pseudo-terminal
+			written = output.size();
 		}
-		// std::cerr << "EB_Forward::write_all done " << size << std::endl;
-
+		output.erase(output.begin(), output.begin()+written);
 	}
-	void EB_Forward::read_all(int fd, char *ptr, int size) 
+
+	bool EB_Forward::pts_writable(int fd, int condition)
 	{
-		while (size > 0) {
-			int result = read(fd, ptr, size);
-			if (result > 0) {
-				size -= result;
-				ptr += result;
-			} else {
-				std::cerr << "EB_Forward::read_all failed" << std::endl;
-				// error... very bad... dont know how to handle this 
-				// this probably means that the device is not connected anymore
-				return;
-			}
+		if (condition & (POLLERR | POLLNVAL)) {
+			output.clear(); // pts_readable will notice and reopen the pseudo-terminal
+		} else {
+			flush_output();
 		}
-		// std::cerr << "EB_Forward::read_all done " << size << std::endl;
+		if (output.empty()) {
+			out_source = saftbus::SourceHandle(); // returning false removes the source from the loop
+			return false;
+		}
+		return true;
 	}
 
 	std::string EB_Forward::eb_forward_path()
@@ -240,4 +365,3 @@ namespace saftlib {
 	}
 
 }
-
@@ -23,7 +23,8 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <deque>
+#include <memory>
 
 #include <saftbus/loop.hpp>
 
@@ -33,34 +34,65 @@ namespace saftlib {
 
     /// @brief Maintains a pseudo-terminal device that mimics a serial etherbone device.
     ///
-    /// All data from the created pseudo terminal (e.g. /dev/pts/14) is read, split-up into complete 
-    /// etherbone packages and redirected to the real hardware. When the real hardware responds to the
-    /// etherbone request, the response is written back to the pseudo-terminal device.
+    /// All data from the created pseudo terminal (e.g. /dev/pts/14) is read in bulk and split-up into
+    /// etherbone records. The records are translated into etherbone cycles on the already opened device, 
+    /// so that they are interleaved with the cycles of saftlib instead of competing for the serial line.
+    /// Cycles are executed asynchronously, several of them can be in flight at the same time. 
+    /// When a cycle completes, the response records are written back to the pseudo-terminal device 
+    /// in the order of the requests.
     /// This effectively allows using eb-tools, such as eb-ls on serial devices, even when the device is
-    /// occupied the TimingReceiver object.
+    /// occupied the TimingReceiver object. The forwarder never blocks the event loop.
 	class EB_Forward : public SdbDevice {
 	public:
 		EB_Forward(const std::string& eb_name, etherbone::Device &device); 
 		~EB_Forward();
 
-		bool accept_connection(int condition);
-
         /// @brief return the name of the pseudo-terminal device
         /// @return the name of the created pseudo-terminal
 		std::string eb_forward_path();
 
 	private:
-		void write_all(int fd, char *ptr, int size);
-		void read_all(int fd, char *ptr, int size);
-		void open_pts();
-		int     _eb_device_fd, _pts_fd; 
-        saftbus::SourceHandle io_source;
+		// one record of the request, as much as is needed to build the response
+		struct Record {
+			uint8_t  flags;
+			uint8_t  byte_enable;
+			uint8_t  shift;       // position of the byte lanes in the 32 bit word (in bits)
+			uint8_t  rcount;
+			uint32_t return_base;
+			size_t   size;        // size of the request record, the response has the same size
+		};
+		// all records up to (and including) the one with the CYC flag
+		struct Transaction {
+			EB_Forward          *forward; // nullptr if the forwarder doesn't wait for the response anymore
+			etherbone::Cycle     cycle;
+			bool                 cycle_open; // cycle.open was called 
+			bool                 closed;     // the record with the CYC flag was seen
+			bool                 done;       // response data is available 
+			etherbone::status_t  status;
+			std::vector<Record>  records;
+			std::deque<eb_data_t> data;      // read results, a deque because cycle.read keeps pointers to the elements
+			std::vector<uint8_t> raw_response; // sent without modification (the reply to an etherbone probe)
+			Transaction(EB_Forward *f) : forward(f), cycle_open(false), closed(false), done(false), status(EB_OK) {}
+		};
+		static void cycle_done(Transaction *transaction, etherbone::Device dev, etherbone::Operation op, etherbone::status_t status);
 
-        std::vector<std::pair<std::string, std::string> > visu;
+		void open_pts();
+		void reset_pts();
+		void release_transactions();
+		bool pts_readable(int fd, int condition);
+		bool pts_writable(int fd, int condition);
+		size_t parse_input();
+		void add_record(const uint8_t *record, size_t size);
+		void send_responses();
+		void flush_output();
 
-        std::vector<uint8_t> request;  // data from eb-tool
-        std::vector<uint8_t> response; // data from device
+		int     _pts_fd; 
+        saftbus::SourceHandle io_source;
+        saftbus::SourceHandle out_source;
 
+        std::vector<uint8_t> input;  // data from eb-tool, not yet processed
+        std::vector<uint8_t> output; // responses that could not be written yet
+        std::deque<std::unique_ptr<Transaction> > transactions; // in order of the requests
 	};
 
 
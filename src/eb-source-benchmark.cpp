@@ -0,0 +1,78 @@
+#include <saftbus/loop.hpp>
+
+#include "eb-source.hpp"
+
+#include <etherbone.h>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+#include <sys/resource.h>
+
+// CPU time (user+system) of this process
+static std::chrono::microseconds cpu_time()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+	     + std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 3) {
+		std::cerr << "Measure the CPU time of idle saftbus::Loop iterations with an EB_Source" << std::endl;
+		std::cerr << "that watches the given etherbone devices. The devices must not be used by" << std::endl;
+		std::cerr << "saftbusd at the same time." << std::endl;
+		std::cerr << "usage: " << argv[0] << " <number-of-iterations> <eb-path> [<eb-path> ...]" << std::endl;
+		std::cout << std::endl;
+		std::cerr << "   example: " << argv[0] << " 1000000 dev/wbm0 dev/ttyUSB0" << std::endl;
+		return 1;
+	}
+	int N;
+	std::istringstream Nin(argv[1]);
+	Nin >> N;
+	if (!Nin || N <= 0) {
+		std::cerr << "cannot read number-of-iterations from " << argv[1] << std::endl;
+		return 1;
+	}
+	try {
+		etherbone::Socket socket;
+		socket.open();
+		std::vector<std::unique_ptr<etherbone::Device> > devices;
+		for (int i = 2; i < argc; ++i) {
+			devices.push_back(std::unique_ptr<etherbone::Device>(new etherbone::Device));
+			devices.back()->open(socket, argv[i]);
+		}
+
+		saftbus::Loop loop;
+		loop.connect<saftlib::EB_Source>(socket);
+
+		auto cpu_start  = cpu_time();
+		auto wall_start = std::chrono::steady_clock::now();
+		for (int i = 0; i < N; ++i) {
+			loop.iteration(false); // never block: the idle loop spins
+		}
+		auto wall_stop  = std::chrono::steady_clock::now();
+		auto cpu_stop   = cpu_time();
+
+		double cpu_ns  = std::chrono::duration_cast<std::chrono::nanoseconds>(cpu_stop-cpu_start).count();
+		double wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wall_stop-wall_start).count();
+		std::cout << "devices:                 " << devices.size() << std::endl;
+		std::cout << "iterations:              " << N << std::endl;
+		std::cout << "CPU time per iteration:  " << cpu_ns/N  << " ns" << std::endl;
+		std::cout << "wall time per iteration: " << wall_ns/N << " ns" << std::endl;
+
+		loop.clear();
+		for (auto &device: devices) {
+			device->close();
+		}
+		socket.close();
+	} catch (etherbone::exception_t &e) {
+		std::cerr << "Etherbone error: " << e << std::endl;
+		return 1;
+	}
+	return 0;
+}
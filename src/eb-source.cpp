@@ -31,17 +31,23 @@
 namespace saftlib {
 
 
+	std::atomic<unsigned> EB_Source::generation(0);
+
 	EB_Source::EB_Source(etherbone::Socket socket_)
-	 : Source(), socket(socket_)
+	 : Source(), socket(socket_), fds_valid(false), fds_generation(0)
 	{
 		fds.reserve(8);
-		fds_it_valid = false;
 	}
 
 	EB_Source::~EB_Source()
 	{
 	}
 
+	void EB_Source::descriptors_changed()
+	{
+		++generation;
+	}
+
 	int EB_Source::add_fd(eb_user_data_t data, eb_descriptor_t fd, uint8_t mode)
 	{
 		// std::cerr << "EB_Source::add_fd " << fd << std::endl;
@@ -56,8 +62,6 @@ namespace saftlib {
 		if ((mode & EB_DESCRIPTOR_IN)  != 0) pfd.events |= POLLIN;
 		if ((mode & EB_DESCRIPTOR_OUT) != 0) pfd.events |= POLLOUT;
 
-		self->add_poll(&pfd);
-
 		return 0;
 	}
 
@@ -65,22 +69,11 @@ namespace saftlib {
 	{
 		EB_Source* self = (EB_Source*)data;
 
-		// check if iterator is valid and (by chance or clever prediction) points to the correct element in the vector<pollfd> fds
-		if (!self->fds_it_valid || self->fds_it->fd != fd) {
-			for (self->fds_it = self->fds.begin(); self->fds_it != self->fds.end(); ++self->fds_it) {
-				if (self->fds_it->fd == fd) {
-					break;
-				}
-			}
-			self->fds_it_valid = true; // even if no fd matches, the iterator is valid after the search procedure
-		}
-
-		if (self->fds_it == self->fds.end()) {
+		if (fd < 0 || fd >= (int)self->fd_index.size() || self->fd_index[fd] < 0) {
 			return 0;
 		}
 
-		int flags = self->fds_it->revents;
-		++self->fds_it; // expect the next call to this function will be with the fd of the proceeding element in vector<pollfd> fds
+		int flags = self->fds[self->fd_index[fd]].revents;
 		return 
 			((mode & EB_DESCRIPTOR_IN)  != 0 && (flags & (POLLIN  | POLLERR | POLLHUP)) != 0) ||
 			((mode & EB_DESCRIPTOR_OUT) != 0 && (flags & (POLLOUT | POLLERR | POLLHUP)) != 0);
@@ -91,6 +84,26 @@ namespace saftlib {
 		return 0;
 	}
 
+	void EB_Source::enumerate_fds()
+	{
+		clear_poll(); 
+		fds.clear();
+		// Find descriptors we need to watch and add them to the list
+		socket.descriptors(this, &EB_Source::add_fd); 
+		// register the pollfds after all of them were added, push_back may move them
+		fd_index.clear();
+		for (unsigned i = 0; i < fds.size(); ++i) {
+			add_poll(&fds[i]);
+			if (fds[i].fd >= (int)fd_index.size()) {
+				fd_index.resize(fds[i].fd+1, -1);
+			}
+			fd_index[fds[i].fd] = i;
+		}
+		fds_valid      = true;
+		fds_generation = generation;
+		fds_enumerated = std::chrono::steady_clock::now();
+	}
+
 	bool EB_Source::prepare(std::chrono::milliseconds &timeout_ms)
 	{
 		// std::cerr << "EB_Source::prepare " << timeout_ms.count() << std::endl;
@@ -102,13 +115,14 @@ namespace saftlib {
 		// Work-around for no TX flow control: flush data now
 		socket.check(now_ms, 0, &no_fd);
 
-		// remove all filedecriptors from list
-		clear_poll(); 
-		fds.clear();
-		// Find descriptors we need to watch and add them to the list
-		socket.descriptors(this, &EB_Source::add_fd); 
-		fds_it = fds.begin(); // position the iterator at the beginnin of the vector
-		fds_it_valid = true;
+		if (!fds_valid || fds_generation != generation || now - fds_enumerated > std::chrono::seconds(1)) {
+			enumerate_fds();
+		} else {
+			// the loop copies revents only if poll reports any event
+			for (auto &pfd: fds) {
+				pfd.revents = 0;
+			}
+		}
 
 		// Determine timeout
 		uint32_t timeout = socket.timeout();
@@ -128,17 +142,21 @@ namespace saftlib {
 
 		// Descriptors ready?
 		for (std::vector<pollfd>::iterator i = fds.begin(); i != fds.end(); ++i) {
+			if ((i->revents & (POLLERR | POLLHUP | POLLNVAL)) != 0) {
+				fds_valid = false; // the descriptor is probably gone
+			}
 			if ((i->revents & i->events) != 0) {
 				// std::cerr << " pollfd " << true << std::endl;
 				return true;
 			}
 		}
 
-		// Timeout ready?
+		// Timeout ready? (0 means there is no timeout, like in prepare)
 		auto now    = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now());
 		auto epoch  = now.time_since_epoch();
 		auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(epoch).count();
-		ready |= socket.timeout() <= now_ms/1000; // why >= ???
+		uint32_t timeout = socket.timeout();
+		ready |= timeout != 0 && timeout <= now_ms/1000;
 
 		// std::cerr << " timeout " << ready << std::endl;
 
@@ -155,6 +173,8 @@ namespace saftlib {
 
 		// Process any pending packets
 		socket.check(now_ms/1000, this, &EB_Source::get_fd);
+		// Processing may have opened or closed connections
+		fds_valid = false;
 
 		return true;
 	}
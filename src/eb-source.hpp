@@ -10,6 +10,8 @@
 
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <chrono>
 
 #include <poll.h>
 
@@ -17,6 +19,11 @@
 
 namespace saftlib {
 	/// @brief an etherbone event source for the saftbus::Loop
+	///
+	/// The file descriptors of the etherbone::Socket are enumerated only if they may have changed:
+	/// after the socket processed input or timeouts (dispatch), after a descriptor reported an error,
+	/// after descriptors_changed() was called, and at least once per second.
+	/// In an idle loop, prepare only flushes the socket.
 	class EB_Source : public saftbus::Source
 	{
 	public:
@@ -25,6 +32,11 @@ namespace saftlib {
 		static int add_fd(eb_user_data_t, eb_descriptor_t, uint8_t mode);
 		static int get_fd(eb_user_data_t, eb_descriptor_t, uint8_t mode);
 
+		/// @brief Tell all EB_Sources to enumerate the descriptors of their socket again.
+		///
+		/// Must be called when an etherbone::Device was opened or closed.
+		static void descriptors_changed();
+
 		bool prepare(std::chrono::milliseconds &timeout_ms);
 		bool check();
 		bool dispatch();
@@ -32,10 +44,15 @@ namespace saftlib {
 
 		~EB_Source();
 	private:
+		void enumerate_fds();
+
 		etherbone::Socket socket;
 		std::vector<pollfd> fds;
-		std::vector<pollfd>::iterator fds_it;
-		bool fds_it_valid;
+		std::vector<int> fd_index; // index into fds for each file descriptor number, -1 if not watched
+		bool fds_valid;
+		unsigned fds_generation;
+		std::chrono::steady_clock::time_point fds_enumerated;
+		static std::atomic<unsigned> generation;
 	};
 
 }
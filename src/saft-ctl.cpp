@@ -28,6 +28,7 @@
 #include <iostream>
 #include <iomanip>
 #include <thread>
+#include <future>
 
 #include <time.h>
 #include <sys/time.h>
@@ -142,7 +143,6 @@ static void displayStatus(std::shared_ptr<TimingReceiver_Proxy> receiver,
   std::shared_ptr<SoftwareActionSink_Proxy> aSink;
 
   map<std::string, std::string>::iterator i;
-  vector<std::string>::iterator j;
 
   // display White Rabbit status
   wrLocked        = receiver->getLocked();
@@ -167,41 +167,92 @@ static void displayStatus(std::shared_ptr<TimingReceiver_Proxy> receiver,
   allSinks = receiver->getSoftwareActionSinks();
   if (allSinks.size() > 0) {
     std::cout << "sinks instantiated on this host: " << allSinks.size() << std::endl;
+    // the status of all sinks is read in one batch, the status of all their conditions in a second one
+    struct SinkStatus {
+      std::future<int64_t>  minOffset, maxOffset;
+      std::future<uint64_t> actionCount, delayedCount, conflictCount, lateCount, earlyCount, overflowCount, signalRate;
+      std::future<vector<std::string> > allConditions;
+    };
+    struct ConditionStatus {
+      std::future<uint64_t> id, mask;
+      std::future<int64_t>  offset;
+      std::future<bool>     acceptDelayed, acceptConflict, acceptEarly, acceptLate, active, destructible;
+      std::future<std::string> owner;
+    };
+    saftbus::Batch batch;
+    vector<SinkStatus> sinkStatus(allSinks.size());
+    vector<vector<ConditionStatus> > conditionStatus(allSinks.size());
+    int n = 0;
+    // the proxies are only used for calls, call-only proxies need no registration at saftbusd
+    for (i = allSinks.begin(); i != allSinks.end(); i++, n++) {
+      aSink = SoftwareActionSink_Proxy::create(i->second, saftbus::SignalGroup::none());
+      SinkStatus &status   = sinkStatus[n];
+      status.minOffset     = aSink->getMinOffset_batch(batch);
+      status.maxOffset     = aSink->getMaxOffset_batch(batch);
+      status.actionCount   = aSink->getActionCount_batch(batch);
+      status.delayedCount  = aSink->getDelayedCount_batch(batch);
+      status.conflictCount = aSink->getConflictCount_batch(batch);
+      status.lateCount     = aSink->getLateCount_batch(batch);
+      status.earlyCount    = aSink->getEarlyCount_batch(batch);
+      status.overflowCount = aSink->getOverflowCount_batch(batch);
+      status.signalRate    = aSink->getSignalRate_batch(batch);
+      status.allConditions = aSink->getAllConditions_batch(batch);
+    }
+    batch.execute();
+    vector<vector<std::string> > allConditions(allSinks.size());
+    for (n = 0; n < (int)allSinks.size(); n++) {
+      allConditions[n] = sinkStatus[n].allConditions.get();
+      conditionStatus[n].resize(allConditions[n].size());
+      for (unsigned c = 0; c < allConditions[n].size(); c++) {
+        std::shared_ptr<SoftwareCondition_Proxy> condition = SoftwareCondition_Proxy::create(allConditions[n][c], saftbus::SignalGroup::none());
+        ConditionStatus &status = conditionStatus[n][c];
+        status.id             = condition->getID_batch(batch);
+        status.mask           = condition->getMask_batch(batch);
+        status.offset         = condition->getOffset_batch(batch);
+        status.acceptDelayed  = condition->getAcceptDelayed_batch(batch);
+        status.acceptConflict = condition->getAcceptConflict_batch(batch);
+        status.acceptEarly    = condition->getAcceptEarly_batch(batch);
+        status.acceptLate     = condition->getAcceptLate_batch(batch);
+        status.active         = condition->getActive_batch(batch);
+        status.destructible   = condition->getDestructible_batch(batch);
+        status.owner          = condition->getOwner_batch(batch);
+      }
+    }
+    batch.execute();
+
     // get status of each sink
-    for (i = allSinks.begin(); i != allSinks.end(); i++) {
-      aSink = SoftwareActionSink_Proxy::create(i->second);
+    for (i = allSinks.begin(), n = 0; i != allSinks.end(); i++, n++) {
+      SinkStatus &sinkStat = sinkStatus[n];
       std::cout << "  " << i->second
-                << " (minOffset: " << aSink->getMinOffset() << " ns"
-                << ", maxOffset: " << aSink->getMaxOffset() << " ns)"
+                << " (minOffset: " << sinkStat.minOffset.get() << " ns"
+                << ", maxOffset: " << sinkStat.maxOffset.get() << " ns)"
                 << std::endl;
-      std::cout << "  -- actions: " << aSink->getActionCount()
-                << ", delayed: "    << aSink->getDelayedCount()
-                << ", conflict: "   << aSink->getConflictCount()
-                << ", late: "       << aSink->getLateCount()
-                << ", early: "      << aSink->getEarlyCount()
-                << ", overflow: "   << aSink->getOverflowCount()
-                << " (max signalRate: " << 1.0 / ((double)aSink->getSignalRate() / 1000000000.0) << "Hz)"
+      std::cout << "  -- actions: " << sinkStat.actionCount.get()
+                << ", delayed: "    << sinkStat.delayedCount.get()
+                << ", conflict: "   << sinkStat.conflictCount.get()
+                << ", late: "       << sinkStat.lateCount.get()
+                << ", early: "      << sinkStat.earlyCount.get()
+                << ", overflow: "   << sinkStat.overflowCount.get()
+                << " (max signalRate: " << 1.0 / ((double)sinkStat.signalRate.get() / 1000000000.0) << "Hz)"
                 << std::endl;
       // get all conditions for this sink
-      vector< std::string > allConditions = aSink->getAllConditions();
-      std::cout << "  -- conditions: " << allConditions.size() << std::endl;
-      for (j = allConditions.begin(); j != allConditions.end(); j++ ) {
-        std::shared_ptr<SoftwareCondition_Proxy> condition = SoftwareCondition_Proxy::create(*j);
+      std::cout << "  -- conditions: " << allConditions[n].size() << std::endl;
+      for (auto &condition: conditionStatus[n]) {
         if (pmode & 1) {std::cout << std::dec; width = 20; fmt = "0d";}
         else           {std::cout << std::hex; width = 16; fmt = "0x";}
         // assemble accept flags config string
         char acceptFlagsConfigStr[] = "....";
-        if (condition->getAcceptDelayed())  acceptFlagsConfigStr[0] = 'd';
-        if (condition->getAcceptConflict()) acceptFlagsConfigStr[1] = 'c';
-        if (condition->getAcceptEarly())    acceptFlagsConfigStr[2] = 'e';
-        if (condition->getAcceptLate())     acceptFlagsConfigStr[3] = 'l';
-        std::cout << "  ---- " << tr_formatActionEvent(condition->getID(), pmode, printJSON) //ID: "   << fmt << std::setw(width) << std::setfill('0') << condition->getID()
-                  << ", mask: "         << fmt << std::setw(width) << std::setfill('0') << condition->getMask()
-                  << ", offset: "       << fmt << std::setw(9)     << std::setfill('0') << condition->getOffset()
+        if (condition.acceptDelayed.get())  acceptFlagsConfigStr[0] = 'd';
+        if (condition.acceptConflict.get()) acceptFlagsConfigStr[1] = 'c';
+        if (condition.acceptEarly.get())    acceptFlagsConfigStr[2] = 'e';
+        if (condition.acceptLate.get())     acceptFlagsConfigStr[3] = 'l';
+        std::cout << "  ---- " << tr_formatActionEvent(condition.id.get(), pmode, printJSON) //ID: "   << fmt << std::setw(width) << std::setfill('0') << condition->getID()
+                  << ", mask: "         << fmt << std::setw(width) << std::setfill('0') << condition.mask.get()
+                  << ", offset: "       << fmt << std::setw(9)     << std::setfill('0') << condition.offset.get()
                   << ", accept: "       << acceptFlagsConfigStr
-                  << ", active: "       << std::dec << condition->getActive()
-                  << ", destructible: " << condition->getDestructible()
-                  << ", owner: "        << condition->getOwner()
+                  << ", active: "       << std::dec << condition.active.get()
+                  << ", destructible: " << condition.destructible.get()
+                  << ", owner: "        << condition.owner.get()
                   << std::endl;
       } // for all conditions
     } // for all sinks
@@ -251,6 +302,16 @@ static void displayInfoHW(std::shared_ptr<SAFTd_Proxy> saftd) {
       std::cout << "  ---- " << j->second << std::endl;
     } // for j
     if (pmode & PMODE_VERBOSE) {
+      std::map<std::string, uint64_t> pollStatistics = aDevice->getMsiPollStatistics();
+      if (pollStatistics.size()) {
+        std::cout << "  --MSI polling:" << std::endl;
+        for (auto &entry: pollStatistics) {
+          std::cout << "  ---- " << std::setw(16) << std::left << entry.first << std::right << " " << entry.second << std::endl;
+        }
+        if (pollStatistics["polls"]) {
+          std::cout << "  ---- " << std::setw(16) << std::left << "hit_ratio" << std::right << " " << 1.0*pollStatistics["polls_with_msi"]/pollStatistics["polls"] << std::endl;
+        }
+      }
       std::map<std::string, std::map<std::string, std::string> > interfaces = aDevice->getInterfaces();
       for (auto &interface: interfaces) {
         std::cout << "Interface: " << interface.first << std::endl;
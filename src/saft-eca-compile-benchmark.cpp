@@ -0,0 +1,132 @@
+#include "SAFTd_Proxy.hpp"
+#include "TimingReceiver_Proxy.hpp"
+#include "SoftwareActionSink_Proxy.hpp"
+#include "SoftwareCondition_Proxy.hpp"
+#include "CommonFunctions.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <string>
+#include <exception>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <cstdio>
+
+#include <sys/types.h>
+#include <signal.h>
+
+typedef std::map<std::string, uint64_t> Statistics;
+
+// ask saft-software-tr to write its etherbone counters and read them back
+static bool read_statistics(pid_t software_tr_pid, Statistics &statistics)
+{
+	const char *filename = "/tmp/simbridge-eb-statistics";
+	std::remove(filename);
+	if (kill(software_tr_pid, SIGUSR1) != 0) {
+		return false;
+	}
+	for (int i = 0; i < 1000; ++i) {
+		std::ifstream in(filename);
+		if (in) {
+			statistics.clear();
+			std::string name;
+			uint64_t value;
+			while (in >> name >> value) {
+				statistics[name] = value;
+			}
+			return true;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+// run the action, print how long it took and (if the pid of saft-software-tr is known)
+// how much etherbone traffic it caused
+static void measure(const std::string &name, pid_t software_tr_pid, std::function<void()> action)
+{
+	Statistics before, after;
+	bool stats = software_tr_pid > 0 && read_statistics(software_tr_pid, before);
+	auto start = std::chrono::steady_clock::now();
+	action();
+	auto stop  = std::chrono::steady_clock::now();
+	stats = stats && read_statistics(software_tr_pid, after);
+
+	std::cout << name << ": " << std::chrono::duration_cast<std::chrono::microseconds>(stop-start).count() << " us";
+	if (stats) {
+		std::cout << ", " << after["cycles"]-before["cycles"]       << " eb cycles"
+		          << ", " << after["records"]-before["records"]     << " eb records"
+		          << ", " << after["writes"]-before["writes"]       << " writes"
+		          << ", " << after["reads"]-before["reads"]         << " reads";
+	}
+	std::cout << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc != 3 && argc != 4) {
+		std::cerr << "Measure how long it takes to recompile the ECA tables for a number of conditions." << std::endl;
+		std::cerr << "If the pid of saft-software-tr is given, also count the etherbone cycles, records" << std::endl;
+		std::cerr << "and read/write operations that the recompile needs." << std::endl;
+		std::cerr << "usage: " << argv[0] << " <saftlib-device> <number-of-conditions> [<saft-software-tr-pid>]" << std::endl;
+		std::cout << std::endl;
+		std::cerr << "   example: " << argv[0] << " tr0 100 $(pidof saft-software-tr)" << std::endl;
+		std::cerr << "   compare with: SAFTLIB_ECA_MAX_WRITES_PER_CYCLE=9 saftbusd ...    (one table entry per cycle)" << std::endl;
+		return 1;
+	}
+	try {
+		int N;
+		std::istringstream Nin(argv[2]);
+		Nin >> N;
+		if (!Nin) {
+			std::cerr << "cannot read number-of-conditions from " << argv[2] << std::endl;
+			return 1;
+		}
+		pid_t software_tr_pid = 0;
+		if (argc == 4) {
+			std::istringstream pid_in(argv[3]);
+			pid_in >> software_tr_pid;
+			if (!pid_in) {
+				std::cerr << "cannot read saft-software-tr-pid from " << argv[3] << std::endl;
+				return 1;
+			}
+		}
+
+		auto saftd = saftlib::SAFTd_Proxy::create("/de/gsi/saftlib");
+		auto tr    = saftlib::TimingReceiver_Proxy::create(std::string("/de/gsi/saftlib/")+argv[1]);
+
+		auto software_action_sink_object_path = tr->NewSoftwareActionSink("");
+		auto software_action_sink             = saftlib::SoftwareActionSink_Proxy::create(software_action_sink_object_path);
+
+		// every NewCondition call recompiles the tables
+		std::vector<std::string> condition_object_paths;
+		measure("create conditions        ", software_tr_pid, [&]() {
+			for (int i = 0; i < N; ++i) {
+				condition_object_paths.push_back(software_action_sink->NewCondition(true, 0xaffe0000+i, -1, 0));
+			}
+		});
+
+		// all entries of the tables change
+		measure("deactivate all conditions", software_tr_pid, [&]() {
+			software_action_sink->ToggleActive();
+		});
+		measure("activate all conditions  ", software_tr_pid, [&]() {
+			software_action_sink->ToggleActive();
+		});
+
+		// only a single walker entry changes
+		if (N > 0) {
+			auto condition = saftlib::SoftwareCondition_Proxy::create(condition_object_paths.back());
+			measure("change one condition     ", software_tr_pid, [&]() {
+				condition->setOffset(1000);
+			});
+		}
+	} catch (std::runtime_error &e ) {
+		std::cerr << "Error: " << e.what() << std::endl;
+	}
+
+	return 0;
+}
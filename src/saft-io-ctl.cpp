@@ -52,6 +52,7 @@
 #include "interfaces/OutputCondition.h"
 
 #include "CommonFunctions.h"
+#include "ConditionBatch.hpp"
 
 #include "eca_flags.h"
 #include "io_control_regs.h"
@@ -153,12 +154,14 @@ static int io_create (bool disown, uint64_t eventID, uint64_t eventMask, int64_t
 
     /* Setup condition */
     std::shared_ptr<OutputCondition_Proxy> condition;
+    ConditionBatch batch(output_proxy); // compile the ECA tables only once
     if (translate_mask) { condition = OutputCondition_Proxy::create(output_proxy->NewCondition(true, eventID, tr_mask(eventMask), io_offset, io_edge)); }
     else                { condition = OutputCondition_Proxy::create(output_proxy->NewCondition(true, eventID, eventMask, io_offset, io_edge)); }
     condition->setAcceptConflict(io_AcceptConflict);
     condition->setAcceptDelayed(io_AcceptDelayed);
     condition->setAcceptEarly(io_AcceptEarly);
     condition->setAcceptLate(io_AcceptLate);
+    batch.commit();
 
     /* Disown and quit or keep waiting */
     if (disown) { condition->Disown(); }
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <iomanip>
 #include <thread>
+#include <vector>
 
 #include <time.h>
 #include <sys/time.h>
@@ -133,6 +134,15 @@ static void on_action(uint64_t id, uint64_t param, saftlib::Time deadline, saftl
   std::cout << std::endl;
 } // on_action
 
+// actions arrive in batches, one saftbus signal for up to actionBatchSize actions
+static const uint32_t actionBatchSize = 64;
+static void on_actions(std::vector<saftlib::ActionRecord> actions)
+{
+  for (auto &action: actions) {
+    on_action(action.event, action.param, saftlib::makeTimeTAI(action.deadline), saftlib::makeTimeTAI(action.executed), action.flags);
+  }
+} // on_actions
+
 
 using namespace saftlib;
 using namespace std;
@@ -565,7 +575,8 @@ int main(int argc, char** argv)
     conditionExtStart->setAcceptEarly(true);
     conditionExtStart->setAcceptConflict(true);
     conditionExtStart->setAcceptDelayed(true);
-    conditionExtStart->SigAction.connect(sigc::ptr_fun(&on_action));
+    conditionExtStart->setBatchSize(actionBatchSize);
+    conditionExtStart->SigActions.connect(sigc::ptr_fun(&on_actions));
     conditionExtStart->setActive(true);
 
     std::shared_ptr<SoftwareCondition_Proxy> conditionExtStop
@@ -575,7 +586,8 @@ int main(int argc, char** argv)
     conditionExtStop->setAcceptEarly(true);
     conditionExtStop->setAcceptConflict(true);
     conditionExtStop->setAcceptDelayed(true);
-    conditionExtStop->SigAction.connect(sigc::ptr_fun(&on_action));
+    conditionExtStop->setBatchSize(actionBatchSize);
+    conditionExtStop->SigActions.connect(sigc::ptr_fun(&on_actions));
     conditionExtStop->setActive(true);
 
     std::shared_ptr<SoftwareCondition_Proxy> conditionExtStopSlow
@@ -585,7 +597,8 @@ int main(int argc, char** argv)
     conditionExtStopSlow->setAcceptEarly(true);
     conditionExtStopSlow->setAcceptConflict(true);
     conditionExtStopSlow->setAcceptDelayed(true);
-    conditionExtStopSlow->SigAction.connect(sigc::ptr_fun(&on_action));
+    conditionExtStopSlow->setBatchSize(actionBatchSize);
+    conditionExtStopSlow->SigActions.connect(sigc::ptr_fun(&on_actions));
     conditionExtStopSlow->setActive(true);
 
     std::shared_ptr<SoftwareCondition_Proxy> conditionCycleStart
@@ -595,7 +608,8 @@ int main(int argc, char** argv)
     conditionCycleStart->setAcceptEarly(true);
     conditionCycleStart->setAcceptConflict(true);
     conditionCycleStart->setAcceptDelayed(true);
-    conditionCycleStart->SigAction.connect(sigc::ptr_fun(&on_action));
+    conditionCycleStart->setBatchSize(actionBatchSize);
+    conditionCycleStart->SigActions.connect(sigc::ptr_fun(&on_actions));
     conditionCycleStart->setActive(true);
 
     std::shared_ptr<SoftwareCondition_Proxy> conditionCycleStop
@@ -605,7 +619,8 @@ int main(int argc, char** argv)
     conditionCycleStop->setAcceptEarly(true);
     conditionCycleStop->setAcceptConflict(true);
     conditionCycleStop->setAcceptDelayed(true);
-    conditionCycleStop->SigAction.connect(sigc::ptr_fun(&on_action));
+    conditionCycleStop->setBatchSize(actionBatchSize);
+    conditionCycleStop->SigActions.connect(sigc::ptr_fun(&on_actions));
     conditionCycleStop->setActive(true);
 
     // set up new thread to snoop for the given number of seconds
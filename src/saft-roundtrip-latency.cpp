@@ -2,6 +2,7 @@
 #include "TimingReceiver_Proxy.hpp"
 #include "SoftwareActionSink_Proxy.hpp"
 #include "SoftwareCondition_Proxy.hpp"
+#include "ConditionBatch.hpp"
 #include "CommonFunctions.hpp"
 
 #include <iostream>
@@ -41,12 +42,14 @@ int main(int argc, char *argv[]) {
 
 		auto software_action_sink_object_path = tr->NewSoftwareActionSink("");
 		auto software_action_sink             = saftlib::SoftwareActionSink_Proxy::create(software_action_sink_object_path);
+		saftlib::ConditionBatch batch(software_action_sink); // compile the ECA tables only once
 		auto condition_object_path            = software_action_sink->NewCondition(true, 0xaffe,-1,0);
 		auto condition                        = saftlib::SoftwareCondition_Proxy::create(condition_object_path);
 		condition->setAcceptEarly(true);
 		condition->setAcceptLate(true);
 		condition->setAcceptConflict(true);
 		condition->setAcceptDelayed(true);
+		batch.commit();
 		condition->SigAction.connect(sigc::ptr_fun(&on_action));
 
 		int N;
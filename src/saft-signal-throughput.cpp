@@ -0,0 +1,113 @@
+#include "SAFTd_Proxy.hpp"
+#include "TimingReceiver_Proxy.hpp"
+#include "SoftwareActionSink_Proxy.hpp"
+#include "SoftwareCondition_Proxy.hpp"
+#include "ConditionBatch.hpp"
+#include "CommonFunctions.hpp"
+
+#include <saftbus/client.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <exception>
+#include <chrono>
+#include <algorithm>
+
+std::chrono::time_point<std::chrono::steady_clock> first, last;
+long received = 0;
+
+static void on_action(uint64_t id, uint64_t param, saftlib::Time deadline, saftlib::Time executed, uint16_t flags)
+{
+	last = std::chrono::steady_clock::now();
+	if (received == 0) {
+		first = last;
+	}
+	++received;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc != 3 && argc != 4) {
+		std::cerr << "Measure how many actions per second arrive at a SoftwareCondition callback" << std::endl;
+		std::cerr << "when the ECA executes bursts of events. Every burst fills the action queue" << std::endl;
+		std::cerr << "of the SoftwareActionSink, all events of a burst have the same deadline." << std::endl;
+		std::cerr << "usage: " << argv[0] << " <saftlib-device> <number-of-bursts> [<signal-batch-size>]" << std::endl;
+		std::cout << std::endl;
+		std::cerr << "   example: " << argv[0] << " tr0 100" << std::endl;
+		std::cerr << "   compare with: " << argv[0] << " tr0 100 1    (one system call per signal)" << std::endl;
+		return 1;
+	}
+	try {
+		int N;
+		std::istringstream Nin(argv[2]);
+		Nin >> N;
+		if (!Nin) {
+			std::cerr << "cannot read number-of-bursts from " << argv[2] << std::endl;
+			return 1;
+		}
+		if (argc == 4) {
+			unsigned batch_size;
+			std::istringstream batch_in(argv[3]);
+			batch_in >> batch_size;
+			if (!batch_in) {
+				std::cerr << "cannot read signal-batch-size from " << argv[3] << std::endl;
+				return 1;
+			}
+			saftbus::SignalGroup::get_global().set_batch_size(batch_size);
+		}
+
+		auto saftd = saftlib::SAFTd_Proxy::create("/de/gsi/saftlib");
+		auto tr    = saftlib::TimingReceiver_Proxy::create(std::string("/de/gsi/saftlib/")+argv[1]);
+
+		auto software_action_sink_object_path = tr->NewSoftwareActionSink("");
+		auto software_action_sink             = saftlib::SoftwareActionSink_Proxy::create(software_action_sink_object_path);
+		saftlib::ConditionBatch batch(software_action_sink); // compile the ECA tables only once
+		auto condition_object_path            = software_action_sink->NewCondition(true, 0xaffe,-1,0);
+		auto condition                        = saftlib::SoftwareCondition_Proxy::create(condition_object_path);
+		condition->setAcceptEarly(true);
+		condition->setAcceptLate(true);
+		condition->setAcceptConflict(true);
+		condition->setAcceptDelayed(true);
+		batch.commit();
+		condition->SigAction.connect(sigc::ptr_fun(&on_action));
+
+		int burst_size = std::max(1, software_action_sink->getCapacity()/2);
+		long injected = 0, lost = 0, intervals = 0;
+		std::chrono::nanoseconds total(0);
+		for (int i = 0; i < N; ++i) {
+			received = 0;
+			// all events of the burst are executed at the same time,
+			// the deadline gives enough time to inject them
+			saftlib::Time deadline = tr->CurrentTime() + 100000*burst_size + 10000000;
+			for (int j = 0; j < burst_size; ++j) {
+				tr->InjectEvent(0xaffe, j, deadline);
+			}
+			injected += burst_size;
+			while (received < burst_size) {
+				if (saftlib::wait_for_signal(1000) == 0) {
+					break; // some actions were lost
+				}
+			}
+			lost += burst_size-received;
+			if (received > 1) {
+				total     += last-first;
+				intervals += received-1;
+			}
+			std::cout << "\r" << i+1 << "/" << N << std::flush;
+		}
+		std::cout << std::endl;
+
+		double seconds = total.count()/1e9;
+		std::cout << "burst size:        " << burst_size << std::endl;
+		std::cout << "injected events:   " << injected << std::endl;
+		std::cout << "lost events:       " << lost << std::endl;
+		std::cout << "overflow count:    " << software_action_sink->getOverflowCount() << std::endl;
+		if (seconds > 0) {
+			std::cout << "events/s in burst: " << intervals/seconds << std::endl;
+		}
+	} catch (std::runtime_error &e ) {
+		std::cerr << "Error: " << e.what() << std::endl;
+	}
+
+	return 0;
+}
@@ -27,6 +27,7 @@
 #include <poll.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <signal.h>
 
 #include <errno.h>
 
@@ -38,6 +39,7 @@
 #include <deque>
 
 #include <cstdint>
+#include <cstdio>
 
 // global variable that controls the amout of output created by all parts of the program
 // verbosity = -1: output only error messages
@@ -73,6 +75,10 @@ bool poll_msis = false; // If this is true, MSIS are provided in registers of  e
 /// The execution time comes from the system time and is not synchronized to a WhiteRabbit network.
 ///
 /// Besides parts of the ECA, not much of the hardware behavior is currently implemented. 
+///
+/// The etherbone slave counts the records, cycles and read/write operations it receives.
+/// On SIGUSR1 the counters are written into the file "/tmp/simbridge-eb-statistics" 
+/// (saft-eca-compile-benchmark uses this to see what a recompile of the ECA tables costs).
 namespace software_tr {
 
 // std_logic values
@@ -127,6 +133,9 @@ public:
 
 	void push_msi(uint32_t adr, uint32_t dat);
 
+	// write the etherbone traffic counters into /tmp/simbridge-eb-statistics
+	void write_statistics();
+
 private:
 	struct pollfd pfds[1];	
 	std::deque<uint32_t> input_word_buffer;
@@ -176,6 +185,13 @@ private:
 
 	uint32_t word_count;
 
+	// etherbone traffic counters
+	uint64_t eb_records;
+	uint64_t eb_cycles;
+	uint64_t eb_writes;
+	uint64_t eb_reads;
+	uint64_t eb_responses;
+
 	bool strobe;
 
 	uint32_t new_header;
@@ -281,6 +297,11 @@ EBslave::EBslave(bool stop_until_connected, uint32_t sdb_adr, uint32_t msi_addr_
 {
 	_stop_until_connected = stop_until_connected;
 	_shutdown = false;
+	eb_records   = 0;
+	eb_cycles    = 0;
+	eb_writes    = 0;
+	eb_reads     = 0;
+	eb_responses = 0;
 	eb_sdb_adr       = sdb_adr;
 	eb_msi_adr_first = msi_addr_first;
 	eb_msi_adr_last  = msi_addr_last;
@@ -393,6 +414,10 @@ int EBslave::master_out(std_logic_t *cyc, std_logic_t *stb, std_logic_t *we, int
 				eb_byte_en  = (word & 0x00ff0000) >> 16;
 				eb_wcount   = (word & 0x0000ff00) >>  8;
 				eb_rcount   = (word & 0x000000ff) >>  0;
+				++eb_records;
+				if (eb_flag_cyc) ++eb_cycles;
+				eb_writes += eb_wcount;
+				eb_reads  += eb_rcount;
 				uint32_t response  = (word & 0x00ff0000); // echo byte_enable
 				         //response |= (word & 0x0000ff00) >> 8; // wcount becomes rcount (no! wcount becomes zero)
 				         response |= (word & 0x000000ff) << 8; // rcount becomes wcount
@@ -677,6 +702,7 @@ void EBslave::send_output_buffer()
 			}
 		}
 		if (write_buffer.size() ) {
+			++eb_responses;
 			int result = write(pfds[0].fd, (void*)&write_buffer[0], write_buffer.size());
 			if (result != (int)write_buffer.size()) {
 				std::cerr << "Error in SEBslave::send_output_buffer: read unexpected number of bytes" << std::endl;
@@ -768,6 +794,23 @@ void EBslave::push_msi(uint32_t adr, uint32_t dat) {
 	msi_queue.push_back(MSI(adr,dat));
 }
 
+void EBslave::write_statistics() {
+	{
+		// write to a temporary file first, readers should never see a half written file
+		std::ofstream statfile("/tmp/simbridge-eb-statistics.tmp");
+		statfile << "records "   << eb_records   << std::endl;
+		statfile << "cycles "    << eb_cycles    << std::endl;
+		statfile << "writes "    << eb_writes    << std::endl;
+		statfile << "reads "     << eb_reads     << std::endl;
+		statfile << "responses " << eb_responses << std::endl;
+	}
+	std::rename("/tmp/simbridge-eb-statistics.tmp", "/tmp/simbridge-eb-statistics");
+	if (verbosity >= 0) {
+		std::cout << "eb statistics: " << eb_records << " records, " << eb_cycles << " cycles, " 
+		          << eb_writes << " writes, " << eb_reads << " reads, " << eb_responses << " responses" << std::endl;
+	}
+}
+
 void EBslave::msi_slave_in(std_logic_t cyc, std_logic_t stb, std_logic_t we, int adr, int dat, int sel) {
 	msi_slave_out_ack = false;
 	msi_slave_out_err = false;
@@ -801,6 +844,11 @@ void EBslave::msi_slave_in(std_logic_t cyc, std_logic_t stb, std_logic_t we, int
 namespace software_tr {
 
 EBslave *eb_slave = nullptr;
+volatile sig_atomic_t statistics_requested = 0;
+
+void request_statistics(int) {
+	statistics_requested = 1;
+}
 uint32_t eca_msi_target_adr = 0;
 uint32_t eca_in_buffer[8] = {0,};
 uint32_t eca_tag = 0;
@@ -1250,6 +1298,30 @@ struct SoftwareECA {
 		bool     fired;
 	};
 	std::map<int, Walker > walker;
+
+	// The ECA has two banks of search and walker tables. saftlib writes the inactive bank 
+	// (only the entries that changed) and flips the banks. The conditions are reconstructed
+	// from the active bank after each flip.
+	std::vector<SearchCandidate> search_bank[2];
+	std::map<int, Walker >       walker_bank[2];
+	int inactive_bank = 0;
+
+	void flip_banks() {
+		inactive_bank = 1-inactive_bank;
+		const std::vector<SearchCandidate> &search = search_bank[1-inactive_bank];
+		// the end of the table is padded with copies of the last entry
+		search_candidates.clear();
+		for (unsigned i = 0; i < search.size(); ++i) {
+			if (i > 0 && search[i].first_walker == search[i-1].first_walker && search[i].search_event == search[i-1].search_event) {
+				break;
+			}
+			search_candidates.push_back(search[i]);
+		}
+		searches.clear();
+		analyse_search_candidates();
+		walker = walker_bank[1-inactive_bank];
+	}
+
 	uint32_t in_buffer[8];
 	uint32_t msi_target_adr;
 	struct Event {
@@ -1382,32 +1454,19 @@ public:
 	}
 
 	bool write_access(uint32_t adr, int sel, uint32_t dat) {
+		static int      selected_search;
 		static int      selected_walker;
-		static int      prev_first_walker, first_walker;
-		static uint64_t prev_search_event, search_event;
-		static bool     end_of_search;
-		static bool     select_first;
-		// static int      null_walker = 0xffff;
+		static int      first_walker;
+		static uint64_t search_event;
+		static SoftwareECA::Walker scratch_walker;
 		switch(adr-_adr_first) {
 			case ECA_SEARCH_SELECT_RW:
 				// std::cerr << "ECA_SEARCH_SELECT_RW " << std::hex << dat << std::endl;
-				select_first = false;
-				if (dat == 0) {
-					if (verbosity >= 1) {
-						std::cout << ">>>>>>>>clear software_eca searches" << std::endl;
-					}
-					software_eca.searches.clear();
-					software_eca.search_candidates.clear();
-					prev_first_walker = -1;
-					prev_search_event = 0;
-					select_first = true;
-					end_of_search = false;
-				} 
+				selected_search = dat;
 				return true;
 			case ECA_SEARCH_RW_FIRST_RW:     
 				// std::cerr << "ECA_SEARCH_RW_FIRST_RW:" << std::hex << dat << std::endl ;
 				first_walker = dat;
-				if (first_walker == 0xffff) first_walker = -1;
 				return true;
 			case ECA_SEARCH_RW_EVENT_HI_RW: 
 				// std::cerr << "ECA_SEARCH_RW_EVENT_HI_RW: " << std::hex << dat << std::endl; 
@@ -1416,24 +1475,21 @@ public:
 				return true;
 			case ECA_SEARCH_RW_EVENT_LO_RW: 
 				// std::cerr << "ECA_SEARCH_RW_EVENT_LO_RW: " << std::hex << dat << std::endl; 
-				// search_rw_event |= dat;
 				search_event |= dat;
-
-
-				// insert the data written into the registers into a search-candiate-list
-				if (prev_search_event == search_event && prev_first_walker == first_walker && !select_first) {
-					if (!end_of_search) {
-						// analyze the search-candidate-list and transform it into a list of tuples (id,mask,first_walker)
-						software_eca.analyse_search_candidates();
-					}
-					end_of_search = true;
+				return true;
+			case ECA_SEARCH_WRITE_OWR: {
+				std::vector<SoftwareECA::SearchCandidate> &search = software_eca.search_bank[software_eca.inactive_bank];
+				if ((int)search.size() <= selected_search) {
+					search.resize(selected_search+1, SoftwareECA::SearchCandidate(-1, 0));
 				}
-				if (!end_of_search) {
-					software_eca.search_candidates.push_back(SoftwareECA::SearchCandidate(first_walker,search_event));
+				search[selected_search] = SoftwareECA::SearchCandidate(first_walker, search_event);
+				return true;
+			}
+			case ECA_FLIP_ACTIVE_OWR:
+				if (verbosity >= 1) {
+					std::cout << ">>>>>>>>flip software_eca tables" << std::endl;
 				}
-
-				prev_first_walker = first_walker;
-				prev_search_event = search_event;
+				software_eca.flip_banks();
 				return true;
 
 	    	case ECA_CHANNEL_SELECT_RW: 
@@ -1453,50 +1509,47 @@ public:
 				return true;
 			case ECA_WALKER_SELECT_RW:
 				// std::cerr << "walker select " << std::dec << dat << std::endl; 
-				// _selected_walker = dat;
 				selected_walker = dat;
-				if (selected_walker == 0) {
-					software_eca.walker.clear();
-				} 
 				return true;
 			case ECA_WALKER_RW_NEXT_RW:         
 				// std::cerr << "ECA_WALKER_RW_NEXT_RW " << std::hex << dat << std::endl;
-				software_eca.walker[selected_walker].next = dat;
+				scratch_walker.next = dat;
 				 return true;
 			case ECA_WALKER_RW_OFFSET_HI_RW:    
 				// std::cerr << "ECA_WALKER_RW_OFFSET_HI_RW " << std::hex << dat << std::endl; 
-				software_eca.walker[selected_walker].offset = dat;
-				software_eca.walker[selected_walker].offset <<= 32;
+				scratch_walker.offset = dat;
+				scratch_walker.offset <<= 32;
 				return true;
 			case ECA_WALKER_RW_OFFSET_LO_RW:    
-				software_eca.walker[selected_walker].offset |= dat;
+				scratch_walker.offset |= dat;
 				//std::cerr << "ECA_WALKER_RW_OFFSET_LO_RW " << std::hex << dat << std::endl; 
 				return true;
 			case ECA_WALKER_RW_TAG_RW:
 				// std::cerr << "walker TAG : " << std::dec << dat << std::endl ;
-				software_eca.walker[selected_walker].tag = dat;
+				scratch_walker.tag = dat;
 				return true;
 			case ECA_WALKER_RW_FLAGS_RW:        
 				//std::cerr << "ECA_WALKER_RW_FLAGS_RW " << std::hex << dat << std::endl; 
-				software_eca.walker[selected_walker].flags = dat;
+				scratch_walker.flags = dat;
 				return true;
 			case ECA_WALKER_RW_CHANNEL_RW:      
 				//std::cerr << "ECA_WALKER_RW_CHANNEL_RW " << std::hex << dat << std::endl; 
-				software_eca.walker[selected_walker].channel = dat;
+				scratch_walker.channel = dat;
 				return true;
 			case ECA_WALKER_RW_NUM_RW:          
 				//std::cerr << "ECA_WALKER_RW_NUM_RW " << std::hex << dat << std::endl; 
-				software_eca.walker[selected_walker].num = dat;
+				scratch_walker.num = dat;
 				return true;
 			case ECA_WALKER_WRITE_OWR:          
 				//std::cerr << "write walker tags " << std::hex << dat << std::endl; /*_walker_tags = _walker_tags_tmp; _walker_tags_tmp.clear();*/ 
+				software_eca.walker_bank[software_eca.inactive_bank][selected_walker] = scratch_walker;
 				if (verbosity >= 1) {
 					std::cout << "walker " << std::dec << selected_walker 
-								<< " next=" << software_eca.walker[selected_walker].next 
-								<< " tag=" << software_eca.walker[selected_walker].tag
-								<< " flags=" << std::hex << software_eca.walker[selected_walker].flags
-								<< " channel=" << std::dec << software_eca.walker[selected_walker].channel
-								<< " num=" << std::dec << software_eca.walker[selected_walker].num
+								<< " next=" << scratch_walker.next 
+								<< " tag=" << scratch_walker.tag
+								<< " flags=" << std::hex << scratch_walker.flags
+								<< " channel=" << std::dec << scratch_walker.channel
+								<< " num=" << std::dec << scratch_walker.num
 								<< std::endl;
 				}
 				return true;
@@ -2047,6 +2100,8 @@ int main(int argc, char *argv[]) {
 		int adr, dat, sel;
 		uint32_t dat_out;
 
+		signal(SIGUSR1, request_statistics);
+
 		std::thread eca_thread(SoftwareECA::eca_events_to_actions, &software_eca);
 
 		int ending_countdown = 3; // after reset, 3 more eb_slave cycles are needed to end the eb_master transaction
@@ -2055,6 +2110,10 @@ int main(int argc, char *argv[]) {
 				eb_slave->shutdown();
 				std::cerr << --ending_countdown << std::endl;
 			}
+			if (statistics_requested) {
+				statistics_requested = 0;
+				eb_slave->write_statistics();
+			}
 			eb_slave->master_out(&cyc,&stb,&we,&adr,&dat,&sel);
 			if (cyc==STD_LOGIC_1 && stb==STD_LOGIC_1) {
 				bool found_adr = false;
@@ -0,0 +1,122 @@
+#include <saftbus/saftbus.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+// On a SOCK_SEQPACKET socket, every write/writev call produces exactly one packet
+// and every read/readv call consumes at most one packet. The number of packets per
+// saftbus message is therefore the number of write calls, and a lower bound for the
+// number of read calls of the receiving side.
+
+// send N messages with Serializer::write_to and count the packets on the other side
+static double packets_per_message(int N, const std::string &payload)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) {
+		throw std::runtime_error("cannot create socketpair");
+	}
+	std::thread writer([&]() {
+		saftbus::Serializer serializer;
+		for (int i = 0; i < N; ++i) {
+			serializer.put(payload);
+			serializer.write_to(fds[0]);
+		}
+		close(fds[0]);
+	});
+	std::vector<char> buffer(payload.size() + 1024);
+	long packets = 0;
+	while (recv(fds[1], &buffer[0], buffer.size(), 0) > 0) {
+		++packets;
+	}
+	writer.join();
+	close(fds[1]);
+	return double(packets)/N;
+}
+
+// send N messages with Serializer::write_to and receive them with Deserializer::read_from
+static double ns_per_message(int N, const std::string &payload)
+{
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) {
+		throw std::runtime_error("cannot create socketpair");
+	}
+	std::thread writer([&]() {
+		saftbus::Serializer serializer;
+		for (int i = 0; i < N; ++i) {
+			serializer.put(payload);
+			serializer.write_to(fds[0]);
+		}
+	});
+	saftbus::Deserializer deserializer;
+	std::string received;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < N; ++i) {
+		if (!deserializer.read_from(fds[1])) {
+			writer.join();
+			throw std::runtime_error("Deserializer::read_from failed");
+		}
+		deserializer.get(received);
+	}
+	auto stop = std::chrono::steady_clock::now();
+	writer.join();
+	close(fds[0]);
+	close(fds[1]);
+	if (received != payload) {
+		throw std::runtime_error("received wrong payload");
+	}
+	return double(std::chrono::duration_cast<std::chrono::nanoseconds>(stop-start).count())/N;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		std::cerr << "Send saftbus messages over a socketpair and report the number of" << std::endl;
+		std::cerr << "write calls (packets) per message and the time per message." << std::endl;
+		std::cerr << "usage: " << argv[0] << " <number-of-messages> [<payload-size> ...]" << std::endl;
+		std::cout << std::endl;
+		std::cerr << "   example: " << argv[0] << " 200000 16 4000 20000" << std::endl;
+		return 1;
+	}
+	int N;
+	std::istringstream Nin(argv[1]);
+	Nin >> N;
+	if (!Nin || N <= 0) {
+		std::cerr << "cannot read number-of-messages from " << argv[1] << std::endl;
+		return 1;
+	}
+	std::vector<int> sizes;
+	for (int i = 2; i < argc; ++i) {
+		int size;
+		std::istringstream in(argv[i]);
+		in >> size;
+		if (!in || size < 0) {
+			std::cerr << "cannot read payload-size from " << argv[i] << std::endl;
+			return 1;
+		}
+		sizes.push_back(size);
+	}
+	if (sizes.empty()) {
+		sizes.push_back(16);
+	}
+	try {
+		std::cout << "payload size   packets/message   ns/message" << std::endl;
+		for (auto size: sizes) {
+			std::string payload(size, 'x');
+			double packets = packets_per_message(N, payload);
+			double ns      = ns_per_message(N, payload);
+			std::cout << std::setw(12) << size << "   " << std::setw(15) << packets << "   " << std::setw(10) << ns << std::endl;
+		}
+	} catch (std::runtime_error &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}